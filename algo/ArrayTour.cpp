@@ -0,0 +1 @@
+#include "ArrayTour.h"
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <utility>
+#include <vector>
+
+namespace NAlgo {
+    /*
+     * Tour as an array with a position index. Next/Prev/Between are O(1); Reverse reverses the
+     * shorter of the path and its complement, which is O(n) in the worst case.
+     *
+     * Reverse(from, to) turns the path from -> ... -> to (following Next) around, so edges
+     * (Prev(from), from), (to, Next(to)) become (Prev(from), to), (from, Next(to)). Reversing the
+     * complement gives the same cycle but flips the direction of Next for the whole tour.
+     */
+    class ArrayTour {
+    public:
+        explicit ArrayTour(std::vector<int> path)
+            : path(std::move(path))
+            , pos(this->path.size())
+        {
+            for (int i = 0; i < (int)this->path.size(); i++) {
+                pos[this->path[i]] = i;
+            }
+        }
+
+        int Size() const {
+            return path.size();
+        }
+
+        int Next(int v) const {
+            int i = pos[v] + 1;
+            return path[i == (int)path.size() ? 0 : i];
+        }
+
+        int Prev(int v) const {
+            int i = pos[v];
+            return path[i == 0 ? path.size() - 1 : i - 1];
+        }
+
+        /* b lies on the path a -> ... -> c */
+        bool Between(int a, int b, int c) const {
+            int pa = pos[a], pb = pos[b], pc = pos[c];
+            if (pa <= pc) {
+                return pa <= pb && pb <= pc;
+            }
+            return pb >= pa || pb <= pc;
+        }
+
+        int At(int i) const {
+            return path[i];
+        }
+
+        int Pos(int v) const {
+            return pos[v];
+        }
+
+        void Reverse(int from, int to) {
+            int n = path.size();
+            int l = pos[from];
+            int r = pos[to];
+            int len = (r - l + n) % n + 1;
+            if (2 * len > n) {
+                int new_l = (r + 1) % n;
+                r = (l - 1 + n) % n;
+                l = new_l;
+                len = n - len;
+            }
+
+            for (int k = 0; k < len / 2; k++) {
+                std::swap(path[l], path[r]);
+                pos[path[l]] = l;
+                pos[path[r]] = r;
+                l = l + 1 == n ? 0 : l + 1;
+                r = r == 0 ? n - 1 : r - 1;
+            }
+        }
+
+        const std::vector<int>& Path() const {
+            return path;
+        }
+
+    private:
+        std::vector<int> path;
+        std::vector<int> pos;
+    };
+}
@@ -0,0 +1 @@
+#include "BestTourTracker.h"
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <algo/ArrayTour.h>
+
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+namespace NAlgo {
+    /*
+        The best tour of an optimizer without copying the path on every improvement. It keeps the best
+        weight and a log of the 2-opt moves made since; the path is restored by undoing the log from the
+        current tour. Once the log holds more moves than the tour has cities, undoing it would cost more
+        than one O(n) copy, so the best path is materialized and the log is dropped until the next
+        improvement.
+     */
+    class BestTourTracker {
+    public:
+        /* 2-opt move replacing (a, b), (c, d) with (a, c), (b, d) */
+        struct Move {
+            int a, b, c, d;
+        };
+
+        BestTourTracker(std::function<std::vector<int>()> current_path, int64_t weight, size_t city_count)
+            : current_path(std::move(current_path))
+            , best_weight(weight)
+            , max_log(std::max(city_count, MIN_LOG))
+        {}
+
+        /* called after every applied move with the weight of the current tour */
+        void Record(const Move& move, int64_t weight) {
+            if (weight < best_weight) {
+                best_weight = weight;
+                log.clear();
+                stored = false;
+                return;
+            }
+            if (stored) {
+                return;
+            }
+
+            log.push_back(move);
+            if (log.size() > max_log) {
+                best_path = BestPath();
+                stored = true;
+                log.clear();
+                materializations++;
+            }
+        }
+
+        int64_t BestWeight() const {
+            return best_weight;
+        }
+
+        std::vector<int> BestPath() const {
+            if (stored) {
+                return best_path;
+            }
+
+            ArrayTour tour(current_path());
+            for (auto it = log.rbegin(); it != log.rend(); ++it) {
+                // (a, c), (b, d) -> (a, b), (c, d)
+                if (tour.Next(it->a) == it->c) {
+                    tour.Reverse(it->c, it->b);
+                } else {
+                    tour.Reverse(it->b, it->c);
+                }
+            }
+            return tour.Path();
+        }
+
+        /* how many times the log overflowed and the best path had to be copied */
+        int64_t Materializations() const {
+            return materializations;
+        }
+
+    private:
+        static constexpr size_t MIN_LOG = 64;
+
+        std::function<std::vector<int>()> current_path;
+        int64_t best_weight;
+        size_t max_log;
+
+        std::vector<Move> log;
+        std::vector<int> best_path;
+        bool stored = false;
+        int64_t materializations = 0;
+    };
+}
@@ -1,7 +1,7 @@
 #pragma once
 
 #include <algo/ISolution.h>
-#include <lib/Timer.h>
+#include <lib/Deadline.h>
 
 #include <numeric>
 #include <algorithm>
@@ -30,13 +30,15 @@ namespace NAlgo {
                 current_tour = std::make_shared<Tour>(test);
 
                 used.assign(test.GetVertexNum(), 0);
-                timer.Reset();
+                deadline = start_deadline();
                 kill_dfs = false;
                 current_weight = 0;
                 order.resize(test.GetVertexNum());
-                iter = 0;
 
-                for (int v = 0; v < test.GetVertexNum(); v++) {
+                // sorting the candidates alone takes O(n^2 log n), the deadline can pass before the search
+                int ordered = 0;
+                for (; ordered < test.GetVertexNum() && !deadline.Expired(); ordered++) {
+                    int v = ordered;
                     order[v].clear();
                     for (int u = 0; u < test.GetVertexNum(); u++) {
                         if (v != u) {
@@ -47,18 +49,31 @@ namespace NAlgo {
                     std::sort(order[v].begin(), order[v].end());
                 }
 
-                dfs(test, test.GetVertexNum());
+                if (ordered == test.GetVertexNum()) {
+                    dfs(test, test.GetVertexNum());
+                }
             }
 
-            Tour result = *best_found;
-            result.CalcTotalWeight();
-            return result;
+            return *best_found;
         }
 
         std::string solution_name() const override {
             return "BranchAndBound";
         }
+
+        bool deterministic() const override {
+            return true;
+        }
     private:
+        /* in a portfolio a tour found by another algorithm prunes the search too */
+        int64_t upper_bound() const {
+            int64_t bound = best_found->TotalWeight();
+            if (config.incumbent) {
+                bound = std::min(bound, config.incumbent->Weight());
+            }
+            return bound;
+        }
+
         int64_t lower_bound(int test_size) {
             int64_t result = 0;
             for (int v = 0; v < test_size; v++) {
@@ -77,21 +92,21 @@ namespace NAlgo {
         }
 
         void dfs(const Test& test, int test_size) {
-            if (iter % 100000 == 0 && timer.Passed() > config.deadline) {
+            if (deadline.Expired()) {
                 kill_dfs = true;
                 return;
             }
-            iter += 1;
 
             if (current_tour->path.size() == test_size) {
-                current_tour->CalcTotalWeight();
-                if (current_tour->TotalWeight() < best_found->TotalWeight()) {
-                    best_found = std::make_unique<Tour>(*current_tour);
+                int64_t weight = current_weight + test.EvalDistance(current_tour->path.back(), current_tour->path.front());
+                if (weight < best_found->TotalWeight()) {
+                    best_found->SetPath(current_tour->path, weight);
+                    publish(weight, deadline.Passed(), [this]() { return current_tour->path; });
                 }
                 return;
             }
 
-            if (current_weight + lower_bound(test_size) > best_found->TotalWeight()) {
+            if (current_weight + lower_bound(test_size) > upper_bound()) {
                 return;
             }
 
@@ -121,10 +136,9 @@ namespace NAlgo {
         std::unique_ptr<Tour> best_found;
         std::shared_ptr<Tour> current_tour;
 
-        Timer timer;
+        Deadline deadline;
         bool kill_dfs;
         int64_t current_weight;
         std::vector<std::vector<std::pair<int64_t, int>>> order;
-        int64_t iter = 0;
     };
 }
@@ -0,0 +1 @@
+#include "ConvergenceRecorder.h"
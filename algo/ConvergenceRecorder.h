@@ -0,0 +1,72 @@
+#pragma once
+
+#include <algo/Tour.h>
+
+#include <chrono>
+#include <vector>
+
+namespace NAlgo {
+    /*
+        Convergence points in bounded memory. A point is kept if the weight dropped below the last
+        kept one or interval_ms has passed since it. At capacity every second point is dropped (the
+        last one stays) and the interval doubles, so the points stay roughly even in time.
+        A disabled recorder ignores Record.
+     */
+    class ConvergenceRecorder {
+    public:
+        explicit ConvergenceRecorder(bool enabled, std::vector<ConvergencePoint> prefix = {},
+                                     size_t capacity = 1024, double interval_ms = 10)
+            : enabled(enabled)
+            , prefix(std::move(prefix))
+            , capacity(std::max<size_t>(capacity, 2))
+            , interval_ms(interval_ms)
+            , start(std::chrono::steady_clock::now())
+        {}
+
+        void Record(int64_t iter, int64_t weight, double duplicate_rate = -1) {
+            if (!enabled) {
+                return;
+            }
+            double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            if (!points.empty() && weight >= points.back().weight && elapsed - points.back().elapsed_ms < interval_ms) {
+                return;
+            }
+
+            if (points.size() == capacity) {
+                size_t kept = 0;
+                for (size_t i = 0; i + 1 < points.size(); i += 2) {
+                    points[kept++] = points[i];
+                }
+                points[kept++] = points.back();
+                points.erase(points.begin() + kept, points.end());
+                interval_ms *= 2;
+            }
+            points.emplace_back(iter, weight, duplicate_rate, elapsed);
+        }
+
+        /* points inherited from the previous stage followed by the recorded ones */
+        std::vector<ConvergencePoint> Points() const {
+            std::vector<ConvergencePoint> all = prefix;
+            all.insert(all.end(), points.begin(), points.end());
+            return all;
+        }
+
+    private:
+        bool enabled;
+        std::vector<ConvergencePoint> prefix;
+        size_t capacity;
+        double interval_ms;
+        std::chrono::steady_clock::time_point start;
+        std::vector<ConvergencePoint> points;
+    };
+
+    /*
+        Every recorder times its points from its own start. When a stage starts start_ms after the
+        points before it began, its points from first on are moved by start_ms so the time only grows.
+     */
+    inline void ShiftConvergence(std::vector<ConvergencePoint>& points, size_t first, double start_ms) {
+        for (size_t i = first; i < points.size(); i++) {
+            points[i].elapsed_ms += start_ms;
+        }
+    }
+}
@@ -0,0 +1 @@
+#include "Crossover.h"
@@ -0,0 +1,420 @@
+#pragma once
+
+#include <algo/NeighbourLists.h>
+#include <algo/Test.h>
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace NAlgo {
+    enum class ECrossoverType : int {
+        Uniform,
+        Order,
+        PartiallyMapped,
+        EdgeRecombination,
+        EdgeAssembly
+    };
+
+    /*
+     * Permutation crossovers. Every kernel is linear (EdgeAssembly is linear plus subtour merging)
+     * and works on per-thread scratch buffers that are allocated once and then reused.
+     */
+    class Crossover {
+    public:
+        using Path = std::vector<int>;
+
+        // neighbours are only needed by EdgeAssembly
+        Crossover(const Test& test, const NeighbourLists* neighbours)
+            : test(test)
+            , neighbours(neighbours)
+        {}
+
+        Path Cross(ECrossoverType type, const Path& first, const Path& second, std::mt19937& gen) const {
+            auto& s = scratch();
+            s.Prepare(first.size());
+
+            Path child(first.size());
+            switch (type) {
+                case ECrossoverType::Uniform:
+                    uniform(first, second, child, s, gen);
+                    break;
+                case ECrossoverType::Order:
+                    order(first, second, child, s, gen);
+                    break;
+                case ECrossoverType::PartiallyMapped:
+                    partially_mapped(first, second, child, s, gen);
+                    break;
+                case ECrossoverType::EdgeRecombination:
+                    edge_recombination(first, second, child, s, gen);
+                    break;
+                case ECrossoverType::EdgeAssembly:
+                    edge_assembly(first, second, child, s, gen);
+                    break;
+            }
+            return child;
+        }
+
+    private:
+        struct Scratch {
+            std::vector<uint64_t> bits;
+            std::vector<uint64_t> used;
+            std::vector<int> pos;
+            std::vector<int> adj;
+            std::vector<int> degree;
+            std::vector<int> unvisited;
+            std::vector<int> link;
+            std::vector<int> other_link;
+            std::vector<int> comp;
+            std::vector<int> trail;
+            std::vector<std::vector<int>> members;
+
+            void Prepare(size_t n) {
+                size_t words = (n + 63) / 64;
+                bits.resize(words);
+                used.assign(words, 0);
+                pos.resize(n);
+                adj.resize(4 * n);
+                degree.resize(n);
+                unvisited.resize(n);
+                link.resize(2 * n);
+                other_link.resize(2 * n);
+                comp.resize(n);
+            }
+
+            bool IsUsed(int v) const {
+                return used[v >> 6] >> (v & 63) & 1;
+            }
+
+            void Use(int v) {
+                used[v >> 6] |= (uint64_t)1 << (v & 63);
+            }
+        };
+
+        static Scratch& scratch() {
+            static thread_local Scratch s;
+            return s;
+        }
+
+        static uint64_t random_word(std::mt19937& gen) {
+            return (uint64_t)gen() << 32 | gen();
+        }
+
+        static std::pair<int, int> random_cut(int n, std::mt19937& gen) {
+            int l = gen() % n;
+            int r = gen() % n;
+            if (r < l) {
+                std::swap(l, r);
+            }
+            return {l, r};
+        }
+
+        void uniform(const Path& first, const Path& second, Path& child, Scratch& s, std::mt19937& gen) const {
+            int n = first.size();
+            for (auto& word : s.bits) {
+                word = random_word(gen);
+            }
+
+            std::fill(child.begin(), child.end(), -1);
+            for (int i = 0; i < n; i++) {
+                if (s.bits[i >> 6] >> (i & 63) & 1) {
+                    s.Use(first[i]);
+                    child[i] = first[i];
+                }
+            }
+            for (int i = 0; i < n; i++) {
+                if (child[i] == -1 && !s.IsUsed(second[i])) {
+                    s.Use(second[i]);
+                    child[i] = second[i];
+                }
+            }
+            for (int i = 0, j = 0; i < n; i++) {
+                if (child[i] == -1) {
+                    while (s.IsUsed(first[j])) {
+                        j++;
+                    }
+                    child[i] = first[j++];
+                }
+            }
+        }
+
+        // OX: keeps a slice of the first parent, the rest follows the order of the second one
+        void order(const Path& first, const Path& second, Path& child, Scratch& s, std::mt19937& gen) const {
+            int n = first.size();
+            auto [l, r] = random_cut(n, gen);
+            for (int i = l; i <= r; i++) {
+                child[i] = first[i];
+                s.Use(first[i]);
+            }
+
+            int write = (r + 1) % n;
+            for (int k = 0, read = (r + 1) % n; k < n; k++, read = read + 1 == n ? 0 : read + 1) {
+                if (!s.IsUsed(second[read])) {
+                    child[write] = second[read];
+                    write = write + 1 == n ? 0 : write + 1;
+                }
+            }
+        }
+
+        // PMX in its swap form: start from the second parent and swap the slice of the first one into place
+        void partially_mapped(const Path& first, const Path& second, Path& child, Scratch& s, std::mt19937& gen) const {
+            int n = first.size();
+            auto [l, r] = random_cut(n, gen);
+            child = second;
+            for (int i = 0; i < n; i++) {
+                s.pos[child[i]] = i;
+            }
+            for (int i = l; i <= r; i++) {
+                int j = s.pos[first[i]];
+                std::swap(child[i], child[j]);
+                s.pos[child[i]] = i;
+                s.pos[child[j]] = j;
+            }
+        }
+
+        // ERX: walk the union of parent edges, always to the neighbour with the fewest edges left
+        void edge_recombination(const Path& first, const Path& second, Path& child, Scratch& s, std::mt19937& gen) const {
+            int n = first.size();
+            std::fill(s.degree.begin(), s.degree.end(), 0);
+            auto add_edge = [&s](int u, int v) {
+                for (int k = 0; k < s.degree[u]; k++) {
+                    if (s.adj[4 * u + k] == v) {
+                        return;
+                    }
+                }
+                s.adj[4 * u + s.degree[u]++] = v;
+            };
+            for (const Path* parent : {&first, &second}) {
+                for (int i = 0; i < n; i++) {
+                    int u = (*parent)[i], v = (*parent)[i + 1 == n ? 0 : i + 1];
+                    add_edge(u, v);
+                    add_edge(v, u);
+                }
+            }
+
+            for (int i = 0; i < n; i++) {
+                s.unvisited[i] = i;
+                s.pos[i] = i;
+            }
+            int unvisited_count = n;
+
+            int current = first[0];
+            for (int step = 0; step < n; step++) {
+                child[step] = current;
+
+                int last = s.unvisited[--unvisited_count];
+                s.unvisited[s.pos[current]] = last;
+                s.pos[last] = s.pos[current];
+
+                int next = -1, ties = 0;
+                for (int k = 0; k < s.degree[current]; k++) {
+                    int w = s.adj[4 * current + k];
+                    for (int t = 0; t < s.degree[w]; t++) {
+                        if (s.adj[4 * w + t] == current) {
+                            s.adj[4 * w + t] = s.adj[4 * w + --s.degree[w]];
+                            break;
+                        }
+                    }
+                    if (next == -1 || s.degree[w] < s.degree[next]) {
+                        next = w;
+                        ties = 1;
+                    } else if (s.degree[w] == s.degree[next] && gen() % ++ties == 0) {
+                        next = w;
+                    }
+                }
+                if (next == -1 && unvisited_count > 0) {
+                    next = s.unvisited[gen() % unvisited_count];
+                }
+                current = next;
+            }
+        }
+
+        /*
+         * EAX with a single AB-cycle: walk an alternating trail of first-only and second-only edges,
+         * swap those edges in the first parent and join the resulting subtours greedily through
+         * candidate neighbours.
+         */
+        void edge_assembly(const Path& first, const Path& second, Path& child, Scratch& s, std::mt19937& gen) const {
+            int n = first.size();
+            auto& link = s.link;
+            auto& other = s.other_link;
+            for (int i = 0; i < n; i++) {
+                int u = first[i], v = first[i + 1 == n ? 0 : i + 1];
+                link[2 * u + 1] = v;
+                link[2 * v] = u;
+                u = second[i], v = second[i + 1 == n ? 0 : i + 1];
+                other[2 * u + 1] = v;
+                other[2 * v] = u;
+            }
+
+            auto has = [](const std::vector<int>& l, int u, int v) {
+                return l[2 * u] == v || l[2 * u + 1] == v;
+            };
+
+            // remaining edges of the trail search: 4 slots per vertex, first two A-only, last two B-only
+            std::fill(s.degree.begin(), s.degree.end(), 0);
+            int start = -1, candidates = 0;
+            for (int u = 0; u < n; u++) {
+                for (int k = 0; k < 2; k++) {
+                    if (!has(other, u, link[2 * u + k])) {
+                        s.adj[4 * u + (s.degree[u] & 3)] = link[2 * u + k];
+                        s.degree[u] += 1;
+                    }
+                    if (!has(link, u, other[2 * u + k])) {
+                        s.adj[4 * u + 2 + (s.degree[u] >> 2)] = other[2 * u + k];
+                        s.degree[u] += 4;
+                    }
+                }
+                if ((s.degree[u] & 3) && gen() % ++candidates == 0) {
+                    start = u;
+                }
+            }
+            if (start == -1) {
+                child = first;
+                return;
+            }
+
+            auto take = [&s](int u, bool a_edge) {
+                int count = a_edge ? (s.degree[u] & 3) : (s.degree[u] >> 2);
+                int base = 4 * u + (a_edge ? 0 : 2);
+                int v = s.adj[base + count - 1];
+                s.degree[u] -= a_edge ? 1 : 4;
+                return v;
+            };
+            auto drop = [&s](int u, int v, bool a_edge) {
+                int count = a_edge ? (s.degree[u] & 3) : (s.degree[u] >> 2);
+                int base = 4 * u + (a_edge ? 0 : 2);
+                for (int k = 0; k < count; k++) {
+                    if (s.adj[base + k] == v) {
+                        s.adj[base + k] = s.adj[base + count - 1];
+                        s.degree[u] -= a_edge ? 1 : 4;
+                        return;
+                    }
+                }
+            };
+
+            s.trail.clear();
+            int u = start;
+            bool a_edge = true;
+            do {
+                int v = take(u, a_edge);
+                drop(v, u, a_edge);
+                s.trail.push_back(u);
+                u = v;
+                a_edge = !a_edge;
+            } while (!(u == start && a_edge));
+            s.trail.push_back(start);
+
+            auto replace = [&link](int u, int from, int to) {
+                link[2 * u + (link[2 * u] == from ? 0 : 1)] = to;
+            };
+            for (size_t k = 0; k + 1 < s.trail.size(); k += 2) {
+                replace(s.trail[k], s.trail[k + 1], -1);
+                replace(s.trail[k + 1], s.trail[k], -1);
+            }
+            for (size_t k = 1; k + 1 < s.trail.size(); k += 2) {
+                replace(s.trail[k], -1, s.trail[k + 1]);
+                replace(s.trail[k + 1], -1, s.trail[k]);
+            }
+
+            int comp_count = label_subtours(n, s);
+            while (comp_count > 1) {
+                merge_smallest_subtour(n, s);
+                comp_count--;
+            }
+
+            for (int i = 0, prev = -1, v = first[0]; i < n; i++) {
+                child[i] = v;
+                int next = link[2 * v] != prev ? link[2 * v] : link[2 * v + 1];
+                prev = v;
+                v = next;
+            }
+        }
+
+        int label_subtours(int n, Scratch& s) const {
+            std::fill(s.comp.begin(), s.comp.end(), -1);
+            s.members.clear();
+            for (int v = 0; v < n; v++) {
+                if (s.comp[v] != -1) {
+                    continue;
+                }
+                int id = s.members.size();
+                s.members.emplace_back();
+                for (int prev = -1, u = v; s.comp[u] == -1;) {
+                    s.comp[u] = id;
+                    s.members[id].push_back(u);
+                    int next = s.link[2 * u] != prev ? s.link[2 * u] : s.link[2 * u + 1];
+                    prev = u;
+                    u = next;
+                }
+            }
+            return s.members.size();
+        }
+
+        void merge_smallest_subtour(int n, Scratch& s) const {
+            auto& link = s.link;
+            int small = -1;
+            for (int id = 0; id < (int)s.members.size(); id++) {
+                if (!s.members[id].empty() && (small == -1 || s.members[id].size() < s.members[small].size())) {
+                    small = id;
+                }
+            }
+
+            int64_t best = LLONG_MAX;
+            int best_u = -1, best_u2 = -1, best_v = -1, best_v2 = -1;
+            auto consider = [&](int u, int v) {
+                for (int i = 0; i < 2; i++) {
+                    int u2 = link[2 * u + i];
+                    int64_t removed_u = test.EvalDistance(u, u2);
+                    for (int j = 0; j < 2; j++) {
+                        int v2 = link[2 * v + j];
+                        int64_t gain = test.EvalDistance(u, v) + test.EvalDistance(u2, v2)
+                            - removed_u - test.EvalDistance(v, v2);
+                        if (gain < best) {
+                            best = gain;
+                            best_u = u, best_u2 = u2, best_v = v, best_v2 = v2;
+                        }
+                    }
+                }
+            };
+
+            for (int u : s.members[small]) {
+                for (int k = 0; neighbours && k < neighbours->Size(); k++) {
+                    int v = neighbours->Get(u, k);
+                    if (s.comp[v] != small) {
+                        consider(u, v);
+                    }
+                }
+            }
+            if (best_u == -1) {
+                for (int u : s.members[small]) {
+                    for (int v = 0; v < n; v++) {
+                        if (s.comp[v] != small) {
+                            consider(u, v);
+                        }
+                    }
+                }
+            }
+
+            auto replace = [&link](int u, int from, int to) {
+                link[2 * u + (link[2 * u] == from ? 0 : 1)] = to;
+            };
+            replace(best_u, best_u2, best_v);
+            replace(best_v, best_v2, best_u);
+            replace(best_u2, best_u, best_v2);
+            replace(best_v2, best_v, best_u2);
+
+            int target = s.comp[best_v];
+            for (int u : s.members[small]) {
+                s.comp[u] = target;
+                s.members[target].push_back(u);
+            }
+            s.members[small].clear();
+        }
+
+        const Test& test;
+        const NeighbourLists* neighbours;
+    };
+}
@@ -0,0 +1 @@
+#include "EdgeSignature.h"
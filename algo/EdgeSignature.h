@@ -0,0 +1,85 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace NAlgo {
+    /*
+        Hash of the undirected edge (u, v), the same for (v, u).
+     */
+    inline uint64_t EdgeKey(int u, int v) {
+        if (u > v) {
+            std::swap(u, v);
+        }
+        // splitmix64 finalizer
+        uint64_t z = ((uint64_t)(uint32_t)u << 32 | (uint32_t)v) + 0x9e3779b97f4a7c15ULL;
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+    /*
+        Zobrist hash of the edge set of a tour: the XOR of its edge keys, independent of the start
+        and the direction. Replacing an edge updates it in O(1).
+     */
+    inline uint64_t EdgeSetHash(const std::vector<int>& path) {
+        uint64_t hash = 0;
+        for (size_t i = 0; i < path.size(); i++) {
+            hash ^= EdgeKey(path[i], path[i + 1 == path.size() ? 0 : i + 1]);
+        }
+        return hash;
+    }
+
+    /*
+     * One-permutation MinHash of the undirected edge set of a tour: every edge falls into one
+     * of SIZE buckets by its hash and the bucket keeps the smallest hash seen. The share of equal
+     * buckets estimates the Jaccard similarity of two edge sets in O(SIZE).
+     */
+    class EdgeSignature {
+    public:
+        static constexpr int SIZE = 32;
+        static constexpr int BAND_ROWS = 4;
+        static constexpr int BANDS = SIZE / BAND_ROWS;
+
+        EdgeSignature() {
+            mins.fill(UINT32_MAX);
+        }
+
+        explicit EdgeSignature(const std::vector<int>& path)
+            : EdgeSignature()
+        {
+            for (size_t i = 0; i < path.size(); i++) {
+                uint64_t key = EdgeKey(path[i], path[i + 1 == path.size() ? 0 : i + 1]);
+                auto& bucket = mins[key % SIZE];
+                bucket = std::min(bucket, (uint32_t)(key >> 32));
+            }
+        }
+
+        double Similarity(const EdgeSignature& other) const {
+            int equal = 0, filled = 0;
+            for (int i = 0; i < SIZE; i++) {
+                if (mins[i] != UINT32_MAX || other.mins[i] != UINT32_MAX) {
+                    filled++;
+                    equal += mins[i] == other.mins[i];
+                }
+            }
+            return filled == 0 ? 1. : 1. * equal / filled;
+        }
+
+        /*
+            LSH key of a band, similar tours likely share at least one band.
+         */
+        uint64_t Band(int band) const {
+            uint64_t key = band;
+            for (int i = band * BAND_ROWS; i < (band + 1) * BAND_ROWS; i++) {
+                key = key * 0x100000001b3ULL ^ mins[i];
+            }
+            return key;
+        }
+
+    private:
+        std::array<uint32_t, SIZE> mins;
+    };
+}
@@ -0,0 +1 @@
+#include "EucSweepRows.h"
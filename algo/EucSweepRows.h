@@ -0,0 +1,107 @@
+#pragma once
+
+#include <algo/Test.h>
+
+#include <cmath>
+#include <vector>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+namespace NAlgo {
+    /*
+        Coordinates and edge lengths (p[i], p[i + 1]) in path order for the full 2-opt sweep on
+        EUC_2D tests. For a fixed l the new edges (p[l - 1], p[r]) and (p[l], p[r + 1]) are computed
+        for four r at once with AVX2, or by the same loop without it. Lengths are doubles, so a
+        candidate is confirmed by the exact delta; deltas <= 0 are candidates so that rounding
+        does not lose improving moves.
+     */
+    class EucSweepRows {
+    public:
+        EucSweepRows(const Test& test, const std::vector<int>& path)
+            : n(path.size())
+            , xs(n + 1)
+            , ys(n + 1)
+            , succ(n)
+        {
+            for (const Point& p : test.GetPoints()) {
+                px.push_back(p.x);
+                py.push_back(p.y);
+            }
+            Refresh(path, 0, n);
+        }
+
+        static bool Supports(const Test& test) {
+            return test.GetWeightType() == "EUC_2D";
+        }
+
+        /* reloads positions start .. start + len - 1 (cyclic) and the edges touching them */
+        void Refresh(const std::vector<int>& path, int start, int len) {
+            for (int k = 0; k < len; k++) {
+                int i = (start + k) % n;
+                xs[i] = px[path[i]];
+                ys[i] = py[path[i]];
+            }
+            xs[n] = xs[0];
+            ys[n] = ys[0];
+            for (int k = -1; k < len; k++) {
+                int i = ((start + k) % n + n) % n;
+                succ[i] = dist(xs[i], ys[i], xs[i + 1], ys[i + 1]);
+            }
+        }
+
+        /* first r in [from, to) whose 2-opt delta for (l, r) may be negative, to if there is none */
+        int FindCandidate(int l, int from, int to) const {
+            int prev = l == 0 ? n - 1 : l - 1;
+            double ax = xs[prev], ay = ys[prev];
+            double bx = xs[l], by = ys[l];
+            double removed = succ[prev];
+
+            int r = from;
+#ifdef __AVX2__
+            __m256d vax = _mm256_set1_pd(ax), vay = _mm256_set1_pd(ay);
+            __m256d vbx = _mm256_set1_pd(bx), vby = _mm256_set1_pd(by);
+            __m256d vremoved = _mm256_set1_pd(removed);
+            __m256d half = _mm256_set1_pd(0.5);
+            for (; r + 4 <= to; r += 4) {
+                __m256d to_prev = vdist(vax, vay, _mm256_loadu_pd(&xs[r]), _mm256_loadu_pd(&ys[r]));
+                __m256d to_l = vdist(vbx, vby, _mm256_loadu_pd(&xs[r + 1]), _mm256_loadu_pd(&ys[r + 1]));
+                __m256d delta = _mm256_sub_pd(
+                    _mm256_add_pd(to_prev, to_l), _mm256_add_pd(vremoved, _mm256_loadu_pd(&succ[r]))
+                );
+                int mask = _mm256_movemask_pd(_mm256_cmp_pd(delta, half, _CMP_LT_OQ));
+                if (mask != 0) {
+                    return r + __builtin_ctz(mask);
+                }
+            }
+#endif
+            for (; r < to; r++) {
+                double delta = dist(ax, ay, xs[r], ys[r]) + dist(bx, by, xs[r + 1], ys[r + 1]) - removed - succ[r];
+                if (delta < 0.5) {
+                    return r;
+                }
+            }
+            return to;
+        }
+
+    private:
+        static double dist(double x1, double y1, double x2, double y2) {
+            return std::floor(std::sqrt((x1 - x2) * (x1 - x2) + (y1 - y2) * (y1 - y2)) + 0.5);
+        }
+
+#ifdef __AVX2__
+        static __m256d vdist(__m256d x1, __m256d y1, __m256d x2, __m256d y2) {
+            __m256d dx = _mm256_sub_pd(x1, x2);
+            __m256d dy = _mm256_sub_pd(y1, y2);
+            __m256d d = _mm256_sqrt_pd(_mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy)));
+            return _mm256_floor_pd(_mm256_add_pd(d, _mm256_set1_pd(0.5)));
+        }
+#endif
+
+        int n;
+        std::vector<double> px, py;
+        std::vector<double> xs, ys;
+        std::vector<double> succ;
+    };
+}
@@ -1,13 +1,24 @@
 #pragma once
 
+#include <algo/ConvergenceRecorder.h>
+#include <algo/Crossover.h>
+#include <algo/EdgeSignature.h>
 #include <algo/ISolution.h>
-#include <lib/Timer.h>
+#include <algo/NeighbourhoodSearch.h>
+#include <lib/Deadline.h>
 #include <lib/ThreadPool.h>
 
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <memory>
 #include <vector>
 #include <numeric>
 #include <random>
 #include <set>
+#include <sstream>
+#include <unordered_map>
+#include <unordered_set>
 #include <iostream>
 
 namespace NAlgo {
@@ -25,185 +36,573 @@ namespace NAlgo {
         Nothing
     };
 
+    enum class EDuplicatePolicy : int {
+        Keep,
+        Reject,
+        Replace
+    };
+
+    enum class EMigrationTopology : int {
+        Ring,
+        Random
+    };
+
     struct GAHyperOpt {
         int population_size = 100;
         EParentSelectType parent_select_type = EParentSelectType::Nothing;
+        // how many individuals inbreeding/outbreeding compares against p1
+        int parent_candidates = 16;
+        // what to do with a child whose edge set is already in the new population
+        EDuplicatePolicy duplicate_policy = EDuplicatePolicy::Keep;
         ESelectType select_type = ESelectType::Tournament;
+        ECrossoverType crossover_type = ECrossoverType::Uniform;
         double proportion_of_crossover = 0.3;
         double proportion_of_mutation = 0.04;
         struct RankingOpt {
             double a = 1.5;
             double b = 2 - a;
         } ranking_opt;
+
+        /*
+         * Island model: island_count > 1 evolves that many sub-populations of population_size
+         * on their own threads. Every migration_interval generations each island sends its
+         * migrant_count best individuals to a neighbour chosen by migration_topology.
+         */
+        int island_count = 1;
+        EMigrationTopology migration_topology = EMigrationTopology::Ring;
+        int migration_interval = 50;
+        int migrant_count = 2;
+        unsigned seed = 0;
+
+        /*
+         * Memetic mode: every child gets a candidate-list 2-opt pass of at most
+         * improvement_budget candidate checks before it enters the next generation.
+         */
+        bool memetic = false;
+        int64_t improvement_budget = 2000;
+        int neighbour_count = 8;
     };
 
     class GeneticAlgorithm : public ISolution {
     public:
         using Path = std::vector<int>;
 
+        struct Individual {
+            Path path;
+            EdgeSignature signature;
+            uint64_t edge_hash = 0;
+            int64_t weight = -1; // -1: not evaluated yet
+        };
+
         explicit GeneticAlgorithm(int version, SolutionConfig config, const GAHyperOpt& hyper_opt = {})
             : ISolution(version, std::move(config))
-            , gen(0)
             , hyper_opt(hyper_opt)
+            , main_gen(hyper_opt.seed)
         {}
 
-        std::pair<Path, Path> genetic_epoch(const Test& test) {
-            auto p1 = select(hyper_opt.select_type, test, test.GetVertexNum());
-            auto p2 = hyper_opt.parent_select_type == EParentSelectType::Nothing
-                      ? select(hyper_opt.select_type, test, test.GetVertexNum())
-                      : choose_parent(hyper_opt.parent_select_type, p1);
+        /* two children of the current population, all random choices are drawn from gen */
+        std::pair<Individual, Individual> genetic_epoch(const Test& test, std::mt19937& gen) {
+            auto started = std::chrono::steady_clock::now();
+            int i1 = select(hyper_opt.select_type, gen);
+            int i2 = hyper_opt.parent_select_type == EParentSelectType::Nothing
+                      ? select(hyper_opt.select_type, gen)
+                      : choose_parent(hyper_opt.parent_select_type, i1, gen);
+            auto p1 = current_population[i1];
+            auto p2 = current_population[i2];
 
-            bool do_crossover = get_random_double() <= hyper_opt.proportion_of_crossover;
-            bool do_mutate_1 = get_random_double() <= hyper_opt.proportion_of_mutation;
-            bool do_mutate_2 = get_random_double() <= hyper_opt.proportion_of_mutation;
+            bool do_crossover = get_random_double(gen) <= hyper_opt.proportion_of_crossover;
+            bool do_mutate_1 = get_random_double(gen) <= hyper_opt.proportion_of_mutation;
+            bool do_mutate_2 = get_random_double(gen) <= hyper_opt.proportion_of_mutation;
 
             if (do_crossover) {
-                auto c1 = cross(p1, p2);
-                auto c2 = cross(p2, p1);
-                p1 = c1;
-                p2 = c2;
+                auto c1 = cross(p1.path, p2.path, gen);
+                auto c2 = cross(p2.path, p1.path, gen);
+                p1 = {std::move(c1), {}, 0, -1};
+                p2 = {std::move(c2), {}, 0, -1};
+                p1.edge_hash = EdgeSetHash(p1.path);
+                p2.edge_hash = EdgeSetHash(p2.path);
             }
 
             if (do_mutate_1) {
-                mutate(p1, test.GetVertexNum());
+                mutate(test, p1, gen);
             }
             if (do_mutate_2) {
-                mutate(p2, test.GetVertexNum());
+                mutate(test, p2, gen);
             }
 
-            return {p1, p2};
+            if (hyper_opt.memetic) {
+                auto improving = std::chrono::steady_clock::now();
+                operators_ns += elapsed_ns(started, improving);
+
+                NeighbourhoodSearch search(test, *neighbours);
+                for (auto* child : {&p1, &p2}) {
+                    int64_t delta = search.Improve(child->path, hyper_opt.improvement_budget, gen() % test.GetVertexNum());
+                    if (delta != 0) {
+                        child->edge_hash = EdgeSetHash(child->path);
+                        if (child->weight != -1) {
+                            child->weight += delta;
+                        }
+                    }
+                }
+                local_search_ns += elapsed_ns(improving, std::chrono::steady_clock::now());
+            }
+
+            return {std::move(p1), std::move(p2)};
         }
 
         Tour solve(const Test& test) override {
-            Tour tour(test);
+            if (hyper_opt.island_count > 1) {
+                return solve_islands(test);
+            }
 
-            current_population = initialize(hyper_opt.population_size, test.GetVertexNum());
+            initialize(test, hyper_opt.population_size);
 
             ThreadPool pool(config.thread_count);
-            timer.Reset();
+            worker_gens.clear();
+            for (int i = 0; i < config.thread_count; i++) {
+                worker_gens.push_back(make_gen(hyper_opt.seed, i + 1));
+            }
+            Deadline deadline = start_deadline();
+            if (needs_neighbours()) {
+                neighbours = std::make_shared<NeighbourLists>(test, hyper_opt.neighbour_count);
+            }
+            crossover = std::make_unique<Crossover>(test, neighbours.get());
 
             int iter = 0;
-            std::vector<std::pair<int, int>> conv;
-            while (timer.Passed() < config.deadline) {
-                std::vector<Path> new_population;
+            ConvergenceRecorder conv(config.save_method_convergence);
+            while (!deadline.Expired()) {
+                next_generation(test, &pool);
+
+                publish(best_weight(), deadline.Passed(), [&]() { return best_individual(test).path; });
+                conv.Record(iter, best_weight(), generation_duplicate_rate);
+                iter++;
+            }
+
+            Tour tour = best_individual(test);
+            tour.convergence = conv.Points();
+            if (hyper_opt.memetic) {
+                save_time_split(tour, operators_ns, local_search_ns);
+            }
+            save_duplicate_stats(tour, children_count, duplicate_count, evaluated_count);
+            assert(tour.TotalWeight() != LONG_LONG_MAX);
+            return tour;
+        }
+
+        std::string solution_name() const override  {
+            return "GeneticAlgorithm";
+        }
+
+        /* the keys of ParseGAHyperOpt, enums by their values */
+        std::string hyperparameters() const override {
+            std::ostringstream out;
+            out << "population=" << hyper_opt.population_size
+                << ",select=" << (int)hyper_opt.select_type
+                << ",ranking=" << hyper_opt.ranking_opt.a << "/" << hyper_opt.ranking_opt.b
+                << ",parent=" << (int)hyper_opt.parent_select_type
+                << ",parent-candidates=" << hyper_opt.parent_candidates
+                << ",duplicates=" << (int)hyper_opt.duplicate_policy
+                << ",crossover=" << (int)hyper_opt.crossover_type
+                << ",crossover-rate=" << hyper_opt.proportion_of_crossover
+                << ",mutation-rate=" << hyper_opt.proportion_of_mutation
+                << ",islands=" << hyper_opt.island_count
+                << ",topology=" << (int)hyper_opt.migration_topology
+                << ",migration-interval=" << hyper_opt.migration_interval
+                << ",migrants=" << hyper_opt.migrant_count
+                << ",seed=" << hyper_opt.seed
+                << ",memetic=" << hyper_opt.memetic
+                << ",improvement-budget=" << hyper_opt.improvement_budget
+                << ",neighbours=" << hyper_opt.neighbour_count;
+            return out.str();
+        }
 
-                if (config.thread_count != 1) {
-                    size_t pool_size = current_population.size() / 2;
-                    std::vector<std::future<std::pair<Path, Path>>> results;
+    private:
+        std::vector<Individual> current_population;
+        // LSH buckets over signature bands, used by inbreeding
+        std::vector<std::unordered_map<uint64_t, std::vector<int>>> band_buckets;
+
+        GAHyperOpt hyper_opt;
+
+        // the main thread draws from main_gen, the i-th task of a parallel generation from worker_gens[i]
+        std::mt19937 main_gen;
+        std::vector<std::mt19937> worker_gens;
+
+        std::shared_ptr<const NeighbourLists> neighbours;
+        std::unique_ptr<Crossover> crossover;
+        std::atomic<int64_t> operators_ns{0};
+        std::atomic<int64_t> local_search_ns{0};
+
+        // weights of recently seen edge sets, keyed by EdgeSetHash
+        std::unordered_map<uint64_t, int64_t> fitness_cache;
+        int64_t children_count = 0;
+        int64_t duplicate_count = 0;
+        int64_t evaluated_count = 0;
+        double generation_duplicate_rate = 0;
+
+        /* a generator of its own for the worker or island index, seeded from the seed of the run */
+        static std::mt19937 make_gen(unsigned seed, int index) {
+            std::seed_seq sequence{seed, (unsigned)index};
+            return std::mt19937(sequence);
+        }
+
+        static int64_t elapsed_ns(std::chrono::steady_clock::time_point from, std::chrono::steady_clock::time_point to) {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(to - from).count();
+        }
+
+        static void save_duplicate_stats(Tour& tour, int64_t children, int64_t duplicates, int64_t evaluated) {
+            tour.statistics["DUPLICATE_RATE"] = 1. * duplicates / std::max<int64_t>(children, 1);
+            tour.statistics["FITNESS_CACHE_HIT_RATE"] = 1. - 1. * evaluated / std::max<int64_t>(children, 1);
+        }
 
-                    for(size_t i = 0; i < pool_size; i++) {
+        static void save_time_split(Tour& tour, int64_t operators, int64_t local_search) {
+            tour.statistics["GENETIC_OPERATORS_MS"] = operators / 1e6;
+            tour.statistics["LOCAL_SEARCH_MS"] = local_search / 1e6;
+            tour.statistics["LOCAL_SEARCH_SHARE"] = 1. * local_search / std::max<int64_t>(operators + local_search, 1);
+        }
+
+        using Mailbox = std::atomic<std::vector<Individual>*>;
+
+        void next_generation(const Test& test, ThreadPool* pool) {
+            size_t target = current_population.size() / 2 * 2;
+            std::vector<Individual> new_population;
+            std::unordered_set<uint64_t> hashes;
+            int64_t produced = 0, duplicates = 0;
+
+            while (new_population.size() < target) {
+                std::vector<std::pair<Individual, Individual>> children;
+
+                if (pool != nullptr && config.thread_count != 1) {
+                    // task i always makes the same share of children from worker_gens[i], so a seed gives one run
+                    size_t pairs = (target - new_population.size() + 1) / 2;
+                    size_t tasks = std::min(worker_gens.size(), pairs);
+                    std::vector<std::future<std::vector<std::pair<Individual, Individual>>>> results;
+
+                    for (size_t i = 0; i < tasks; i++) {
+                        size_t count = pairs / tasks + (i < pairs % tasks);
                         results.emplace_back(
-                            pool.enqueue([this, &test](){
-                                auto [p1, p2] = genetic_epoch(test);
-                                return std::make_pair(p1, p2);
+                            pool->enqueue([this, &test, i, count]() {
+                                std::vector<std::pair<Individual, Individual>> made;
+                                for (size_t k = 0; k < count; k++) {
+                                    made.push_back(genetic_epoch(test, worker_gens[i]));
+                                }
+                                return made;
                             })
                         );
                     }
 
-                    for(auto && result: results) {
-                        auto [p1, p2] = result.get();
-                        new_population.push_back(p1);
-                        new_population.push_back(p2);
+                    for (auto&& result : results) {
+                        for (auto& pair : result.get()) {
+                            children.push_back(std::move(pair));
+                        }
                     }
                 } else {
-                    while ((int) new_population.size() + 1 < (int) current_population.size()) {
-                        auto [p1, p2] = genetic_epoch(test);
+                    children.push_back(genetic_epoch(test, main_gen));
+                }
 
-                        new_population.push_back(std::move(p1));
-                        new_population.push_back(std::move(p2));
+                for (auto& [c1, c2] : children) {
+                    for (auto* child : {&c1, &c2}) {
+                        if (new_population.size() == target) {
+                            break;
+                        }
+                        produced++;
+                        if (!hashes.insert(child->edge_hash).second) {
+                            duplicates++;
+                            // rejecting is given up once the generation produced too many duplicates
+                            if (hyper_opt.duplicate_policy == EDuplicatePolicy::Reject && produced <= 4 * (int64_t)target) {
+                                continue;
+                            }
+                            if (hyper_opt.duplicate_policy == EDuplicatePolicy::Replace) {
+                                make_unique(test, *child, hashes);
+                            }
+                        }
+                        new_population.push_back(std::move(*child));
                     }
                 }
-                current_population = std::vector<Path>(new_population.begin(), new_population.end());
+            }
 
-                if (config.save_method_convergence) {
-                    int64_t best_weight = LONG_LONG_MAX;
+            for (auto& ind : new_population) {
+                evaluated_count += finish_individual(test, ind);
+            }
+            current_population = std::move(new_population);
+            index_population();
 
-                    Tour candidate(test), best(test);
-                    for (size_t i = 0; i < current_population.size(); i++) {
-                        candidate.path = current_population[i];
-                        candidate.CalcTotalWeight();
-                        if (candidate.TotalWeight() < tour.TotalWeight()) {
-                            best = candidate;
-                        }
-                    }
-                    best.CalcTotalWeight();
-                    conv.emplace_back(iter, best.TotalWeight());
+            if (fitness_cache.size() > 16 * target) {
+                fitness_cache.clear();
+            }
+            children_count += produced;
+            duplicate_count += duplicates;
+            generation_duplicate_rate = 1. * duplicates / std::max<int64_t>(produced, 1);
+        }
+
+        void make_unique(const Test& test, Individual& child, std::unordered_set<uint64_t>& hashes) {
+            for (int attempt = 0; attempt < 8; attempt++) {
+                mutate(test, child, main_gen);
+                if (hashes.insert(child.edge_hash).second) {
+                    return;
                 }
-                iter++;
             }
+        }
+
+        /*
+         * Fills the signature and the weight of a new individual. The weight is taken from
+         * the fitness cache when the same edge set was evaluated recently.
+         */
+        bool finish_individual(const Test& test, Individual& ind) {
+            if (uses_signatures()) {
+                ind.signature = EdgeSignature(ind.path);
+            }
+            if (ind.weight != -1) {
+                return false;
+            }
+
+            auto it = fitness_cache.find(ind.edge_hash);
+            if (it != fitness_cache.end()) {
+                ind.weight = it->second;
+                return false;
+            }
+
+            ind.weight = Tour::PathWeight(test, ind.path);
+            fitness_cache.emplace(ind.edge_hash, ind.weight);
+            return true;
+        }
+
+        bool needs_neighbours() const {
+            return hyper_opt.memetic || hyper_opt.crossover_type == ECrossoverType::EdgeAssembly;
+        }
+
+        bool uses_signatures() const {
+            return hyper_opt.parent_select_type != EParentSelectType::Nothing;
+        }
 
-            std::vector<int64_t> all_weights;
-            Tour candidate(test);
+        void index_population() {
+            if (hyper_opt.parent_select_type != EParentSelectType::Inbreeding) {
+                return;
+            }
+            band_buckets.assign(EdgeSignature::BANDS, {});
             for (size_t i = 0; i < current_population.size(); i++) {
-                candidate.path = current_population[i];
-                candidate.CalcTotalWeight();
-                all_weights.push_back(candidate.TotalWeight());
+                for (int band = 0; band < EdgeSignature::BANDS; band++) {
+                    band_buckets[band][current_population[i].signature.Band(band)].push_back(i);
+                }
+            }
+        }
+
+        Tour solve_islands(const Test& test) {
+            int island_count = hyper_opt.island_count;
+
+            SolutionConfig island_config = config;
+            island_config.thread_count = 1;
+
+            std::vector<std::unique_ptr<GeneticAlgorithm>> islands;
+            for (int i = 0; i < island_count; i++) {
+                GAHyperOpt island_opt = hyper_opt;
+                island_opt.island_count = 1;
+                islands.push_back(std::make_unique<GeneticAlgorithm>(version, island_config, island_opt));
+                // every island thread draws only from the generator of its own island
+                islands.back()->main_gen = make_gen(hyper_opt.seed, i + 1);
+            }
+
+            /*
+             * Each island owns one mailbox. A sender swaps a fresh batch of migrants in and drops
+             * the batch the receiver has not picked up yet, so nobody ever waits for anybody.
+             */
+            std::vector<Mailbox> mailboxes(island_count);
+            for (auto& mailbox : mailboxes) {
+                mailbox.store(nullptr);
+            }
+
+            Deadline deadline = start_deadline();
+            if (needs_neighbours()) {
+                neighbours = std::make_shared<NeighbourLists>(test, hyper_opt.neighbour_count);
+            }
+            for (auto& island : islands) {
+                island->neighbours = neighbours;
+                island->crossover = std::make_unique<Crossover>(test, neighbours.get());
+            }
+
+            ThreadPool pool(island_count);
+            std::vector<std::future<std::vector<ConvergencePoint>>> results;
+            for (int i = 0; i < island_count; i++) {
+                results.emplace_back(
+                    pool.enqueue([i, &islands, &mailboxes, &test, &deadline]() {
+                        return islands[i]->evolve_island(test, i, mailboxes, deadline);
+                    })
+                );
+            }
+
+            // island points in time order; every merged point has the best weight over the islands so far
+            std::vector<std::pair<ConvergencePoint, int>> island_points;
+            for (int i = 0; i < island_count; i++) {
+                for (const auto& point : results[i].get()) {
+                    island_points.emplace_back(point, i);
+                }
+            }
+            std::stable_sort(island_points.begin(), island_points.end(), [](const auto& a, const auto& b) {
+                return a.first.elapsed_ms < b.first.elapsed_ms;
+            });
+            std::vector<ConvergencePoint> conv;
+            std::vector<int64_t> island_weight(island_count, LONG_LONG_MAX);
+            std::vector<double> island_duplicate_rate(island_count, -1);
+            for (auto [point, i] : island_points) {
+                island_weight[i] = point.weight;
+                island_duplicate_rate[i] = point.duplicate_rate;
+                point.weight = *std::min_element(island_weight.begin(), island_weight.end());
+                double rate_sum = 0;
+                int rates = 0;
+                for (double rate : island_duplicate_rate) {
+                    if (rate >= 0) {
+                        rate_sum += rate;
+                        rates++;
+                    }
+                }
+                point.duplicate_rate = rates > 0 ? rate_sum / rates : -1;
+                conv.push_back(point);
+            }
+
+            for (auto& mailbox : mailboxes) {
+                delete mailbox.exchange(nullptr);
+            }
+
+            Tour tour(test);
+            int64_t operators = 0, local_search = 0;
+            int64_t children = 0, duplicates = 0, evaluated = 0;
+            for (auto& island : islands) {
+                auto candidate = island->best_individual(test);
                 if (candidate.TotalWeight() < tour.TotalWeight()) {
                     tour = candidate;
                 }
+                operators += island->operators_ns;
+                local_search += island->local_search_ns;
+                children += island->children_count;
+                duplicates += island->duplicate_count;
+                evaluated += island->evaluated_count;
             }
-            tour.CalcTotalWeight();
             tour.convergence = conv;
+            if (hyper_opt.memetic) {
+                save_time_split(tour, operators, local_search);
+            }
+            save_duplicate_stats(tour, children, duplicates, evaluated);
             assert(tour.TotalWeight() != LONG_LONG_MAX);
             return tour;
         }
 
-        std::string solution_name() const override  {
-            return "GeneticAlgorithm";
+        std::vector<ConvergencePoint> evolve_island(
+            const Test& test,
+            int island,
+            std::vector<Mailbox>& mailboxes,
+            const Deadline& deadline
+        ) {
+            initialize(test, hyper_opt.population_size);
+
+            int iter = 0;
+            ConvergenceRecorder conv(config.save_method_convergence);
+            while (!deadline.ExpiredNow()) {
+                next_generation(test, nullptr);
+
+                std::unique_ptr<std::vector<Individual>> arrived(mailboxes[island].exchange(nullptr));
+                if (arrived) {
+                    immigrate(*arrived);
+                }
+
+                if (hyper_opt.migration_interval > 0 && (iter + 1) % hyper_opt.migration_interval == 0) {
+                    int target = migration_target(island, (int)mailboxes.size());
+                    delete mailboxes[target].exchange(new std::vector<Individual>(emigrants()));
+                }
+
+                publish(best_weight(), deadline.Passed(), [&]() { return best_individual(test).path; });
+                conv.Record(iter, best_weight(), generation_duplicate_rate);
+                iter++;
+            }
+            return conv.Points();
         }
 
+        int migration_target(int island, int island_count) {
+            if (hyper_opt.migration_topology == EMigrationTopology::Random) {
+                int target = main_gen() % (island_count - 1);
+                return target < island ? target : target + 1;
+            }
+            return (island + 1) % island_count;
+        }
 
-    private:
-        std::vector<Path> current_population;
+        std::vector<int> order_by_weight() const {
+            std::vector<int> index(current_population.size());
+            std::iota(index.begin(), index.end(), 0);
+            std::sort(index.begin(), index.end(), [this](int i, int j) {
+                return current_population[i].weight < current_population[j].weight;
+            });
+            return index;
+        }
 
-        GAHyperOpt hyper_opt;
+        std::vector<Individual> emigrants() const {
+            auto index = order_by_weight();
+            size_t count = std::min((size_t)std::max(hyper_opt.migrant_count, 0), index.size());
 
-        std::mt19937 gen;
-        Timer timer;
+            std::vector<Individual> result;
+            for (size_t i = 0; i < count; i++) {
+                result.push_back(current_population[index[i]]);
+            }
+            return result;
+        }
+
+        void immigrate(std::vector<Individual>& migrants) {
+            auto index = order_by_weight();
+            for (size_t i = 0; i < migrants.size() && i < index.size(); i++) {
+                current_population[index[index.size() - 1 - i]] = std::move(migrants[i]);
+            }
+            index_population();
+        }
 
-        std::vector<Path> initialize(int count, int vertex_num) {
-            std::vector<Path> population;
-            population.resize(count);
+        int64_t best_weight() const {
+            int64_t best = LONG_LONG_MAX;
+            for (const auto& ind : current_population) {
+                best = std::min(best, ind.weight);
+            }
+            return best;
+        }
+
+        Tour best_individual(const Test& test) const {
+            Tour best(test);
+            auto index = order_by_weight();
+            if (!index.empty()) {
+                const Individual& ind = current_population[index[0]];
+                best.SetPath(ind.path, ind.weight);
+            }
+            return best;
+        }
+
+        void initialize(const Test& test, int count) {
+            int vertex_num = test.GetVertexNum();
+            current_population.clear();
+            fitness_cache.clear();
 
             Path default_path(vertex_num);
             std::iota(default_path.begin(), default_path.end(), 0);
 
             for (int i = 0; i < count; i++) {
-                population[i] = default_path;
-                std::shuffle(population[i].begin() + 1, population[i].end(), gen);
+                Path path = default_path;
+                std::shuffle(path.begin() + 1, path.end(), main_gen);
+                Individual ind{std::move(path), {}, 0, -1};
+                ind.edge_hash = EdgeSetHash(ind.path);
+                finish_individual(test, ind);
+                current_population.push_back(std::move(ind));
             }
-            return population;
+            index_population();
         }
 
-        Path select(ESelectType select_type, const Test& test, int vertex_num) {
+        int select(ESelectType select_type, std::mt19937& gen) {
             if (select_type == ESelectType::Tournament) {
                 int i = gen() % (int)current_population.size();
                 int j = gen() % (int)current_population.size();
 
-                Tour tour_i(test), tour_j(test);
-
-                for (int k = 0; k < vertex_num; k++) {
-                    tour_i.path.push_back(current_population[i][k]);
-                    tour_j.path.push_back(current_population[j][k]);
-                }
-
-                tour_i.CalcTotalWeight();
-                tour_j.CalcTotalWeight();
-
-                if (tour_i.TotalWeight() > tour_j.TotalWeight()) {
-                    return current_population[j];
+                if (current_population[i].weight > current_population[j].weight) {
+                    return j;
                 } else {
-                    return current_population[i];
+                    return i;
                 }
             } else if (select_type == ESelectType::RouletteMethod || select_type == ESelectType::Ranking) {
                 int64_t total_weight_for_all = 0;
                 std::vector<int64_t> total_weights;
-                Tour tour(test);
 
                 for (const auto& ind : current_population) {
-                    tour.path = ind;
-                    tour.CalcTotalWeight();
-                    total_weights.push_back(tour.TotalWeight());
+                    total_weights.push_back(ind.weight);
                     total_weight_for_all += total_weights.back();
                 }
 
@@ -243,7 +642,7 @@ namespace NAlgo {
                     }
                 }
 
-                auto rnd = get_random_double();
+                auto rnd = get_random_double(gen);
                 double sum = 0;
                 int to_select = -1;
                 for (size_t i = 0; i < current_population.size(); i++) {
@@ -257,89 +656,82 @@ namespace NAlgo {
                 }
 
                 assert(to_select != -1);
-                return current_population[to_select];
+                return to_select;
             } else if (select_type == ESelectType::UniformRanking) {
 
             } else if (select_type == ESelectType::SigmaClipping) {
 
             }
 
-            return {};
+            return gen() % (int)current_population.size();
         }
 
-        Path choose_parent(EParentSelectType select_type, const Path& p1) {
+        /*
+         * Compares p1 with parent_candidates individuals by MinHash edge similarity. Inbreeding
+         * takes its candidates from the LSH buckets p1 falls into, so both variants cost
+         * O(parent_candidates) signature comparisons regardless of the population size.
+         */
+        int choose_parent(EParentSelectType select_type, int p1, std::mt19937& gen) {
             if (select_type == EParentSelectType::Inbreeding || select_type == EParentSelectType::Outbreeding) {
-                int par2 = 0;
-                int best_count = select_type == EParentSelectType::Inbreeding ? -1 : INT_MAX;
-
-                for (size_t i = 0; i < current_population.size(); i++) {
-                    if (current_population[i] != p1) {
-                        int count = 0;
-                        for (size_t j = 0; j < current_population.size(); j++) {
-                            count += p1[j] == current_population[i][j];
+                const auto& signature = current_population[p1].signature;
+                int population_size = current_population.size();
+                int limit = std::max(hyper_opt.parent_candidates, 1);
+
+                std::vector<int> candidates;
+                if (select_type == EParentSelectType::Inbreeding) {
+                    for (int band = 0; band < EdgeSignature::BANDS && (int)candidates.size() < limit; band++) {
+                        auto it = band_buckets[band].find(signature.Band(band));
+                        if (it == band_buckets[band].end()) {
+                            continue;
                         }
-                        if (
-                            (select_type == EParentSelectType::Inbreeding && count > best_count) ||
-                            (select_type == EParentSelectType::Outbreeding && count < best_count)
-                        ){
-                            best_count = count;
-                            par2 = i;
+                        const auto& bucket = it->second;
+                        size_t start = gen() % bucket.size();
+                        for (size_t k = 0; k < bucket.size() && (int)candidates.size() < limit; k++) {
+                            int i = bucket[(start + k) % bucket.size()];
+                            if (i != p1) {
+                                candidates.push_back(i);
+                            }
                         }
                     }
                 }
-                return current_population[par2];
-            }
-
-            return {};
-        }
-
-        Path cross(const Path& first_parent, const Path& second_parent) {
-            std::vector<char> used(first_parent.size(), 0);
-
-            auto gen_bitmask = [this](int n) {
-                std::vector<char> res(n);
-                for (int i = 0; i < n; i++) {
-                    res[i] = gen() % 2;
-                }
-                return res;
-            };
-
-            auto bitmask = gen_bitmask(first_parent.size());
-
-            Path child(first_parent.size(), -1);
-            int tf1 = 0, tf2 = 0, tf3 = 0;
-
-            for (size_t i = 0; i < first_parent.size(); i++) {
-                if (bitmask[i]) {
-                    used[first_parent[i]] = 1;
-                    child[i] = first_parent[i];
-                }
-            }
-
-            for (size_t i = 0; i < second_parent.size(); i++) {
-                if (child[i] == -1 && !used[second_parent[i]]) {
-                    used[second_parent[i]] = 1;
-                    child[i] = second_parent[i];
+                while ((int)candidates.size() < limit) {
+                    candidates.push_back(gen() % population_size);
                 }
-            }
 
-            Path rest;
-            for (size_t i = 0; i < first_parent.size(); i++) {
-                if (!used[first_parent[i]]) {
-                    rest.push_back(first_parent[i]);
+                int par2 = p1;
+                double best_similarity = select_type == EParentSelectType::Inbreeding ? -1 : 2;
+                for (int i : candidates) {
+                    if (i == p1) {
+                        continue;
+                    }
+                    double similarity = signature.Similarity(current_population[i].signature);
+                    if (similarity == 1) {
+                        continue;
+                    }
+                    if (
+                        (select_type == EParentSelectType::Inbreeding && similarity > best_similarity) ||
+                        (select_type == EParentSelectType::Outbreeding && similarity < best_similarity)
+                    ) {
+                        best_similarity = similarity;
+                        par2 = i;
+                    }
                 }
+                return par2;
             }
 
-            for (size_t i = 0, j = 0; i < first_parent.size(); i++) {
-                if (child[i] == -1) {
-                    child[i] = rest[j++];
-                }
-            }
+            return p1;
+        }
 
-            return child;
+        Path cross(const Path& first_parent, const Path& second_parent, std::mt19937& gen) {
+            return crossover->Cross(hyper_opt.crossover_type, first_parent, second_parent, gen);
         }
 
-        void mutate(Path& p, int vertex_num) {
+        /*
+         * Reverses a random segment. The edge hash and the weight (if known) are updated from
+         * the two edges that change.
+         */
+        void mutate(const Test& test, Individual& ind, std::mt19937& gen) {
+            int vertex_num = test.GetVertexNum();
             int l = gen() % vertex_num;
             int r = gen() % vertex_num;
 
@@ -351,10 +743,17 @@ namespace NAlgo {
                 return;
             }
 
+            auto& p = ind.path;
+            int prev = p[l - 1], next = p[(r + 1) % vertex_num];
+            ind.edge_hash ^= EdgeKey(prev, p[l]) ^ EdgeKey(p[r], next) ^ EdgeKey(prev, p[r]) ^ EdgeKey(p[l], next);
+            if (ind.weight != -1) {
+                ind.weight += test.EvalDistance(prev, p[r]) + test.EvalDistance(p[l], next)
+                    - test.EvalDistance(prev, p[l]) - test.EvalDistance(p[r], next);
+            }
             std::reverse(p.begin() + l, p.begin() + r + 1);
         }
 
-        double get_random_double() {
+        static double get_random_double(std::mt19937& gen) {
             return 1. * gen() / UINT32_MAX;
         }
     };
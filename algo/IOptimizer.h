@@ -1,12 +1,23 @@
 #pragma once
 
+#include <algo/Improvement.h>
+#include <algo/Incumbent.h>
 #include <algo/Test.h>
 #include <algo/Tour.h>
+#include <lib/Deadline.h>
+
+#include <memory>
 
 namespace NAlgo {
     struct OptimizerConfig {
         double deadline;
         bool save_method_convergence;
+        int thread_count = 1;
+        /* cancels the run before the deadline, optional */
+        std::shared_ptr<CancelToken> cancel = nullptr;
+        /* set when the test is solved by a portfolio of algorithms at once */
+        std::shared_ptr<Incumbent> incumbent = nullptr;
+        ImprovementCallback on_improvement = nullptr;
     };
 
     class IOptimizer {
@@ -22,6 +33,11 @@ namespace NAlgo {
 
         virtual std::string optimizer_name() const = 0;
 
+        /* optimize gives the same tour for the same baseline every time it returns before the deadline */
+        virtual bool deterministic() const {
+            return false;
+        }
+
         int optimizer_version() const {
             return version;
         }
@@ -30,14 +46,43 @@ namespace NAlgo {
             return config.deadline;
         }
 
+        void set_deadline(double deadline) {
+            config.deadline = deadline;
+        }
+
+        void set_improvement_callback(ImprovementCallback callback) {
+            config.on_improvement = std::move(callback);
+        }
+
     protected:
+        /* config.deadline counted from now, every loop of the algorithm polls it */
+        Deadline start_deadline() const {
+            return Deadline(config.deadline, config.cancel);
+        }
+
+        /* the best weight so far, called at the pace of the convergence records */
+        void publish(int64_t weight, double elapsed_ms, std::function<std::vector<int>()> path = nullptr) const {
+            if (config.incumbent) {
+                config.incumbent->Offer(weight);
+            }
+            if (config.on_improvement) {
+                config.on_improvement({weight, elapsed_ms, std::move(path)});
+            }
+        }
+
         int version;
         OptimizerConfig config;
     };
 
     enum class EOptimizer : int {
         LocalSearch,
-        SimulatedAnnealing
+        SimulatedAnnealing,
+        NeighbourTwoOpt,
+        OrOpt,
+        LinKernighan,
+        PartitionTwoOpt,
+        VectorLocalSearch,
+        ParallelTempering
     };
 }
 
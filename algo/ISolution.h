@@ -1,6 +1,11 @@
 #pragma once
 
+#include <algo/Improvement.h>
+#include <algo/Incumbent.h>
 #include <algo/Tour.h>
+#include <lib/Deadline.h>
+
+#include <memory>
 #include <string>
 
 namespace NAlgo {
@@ -8,6 +13,11 @@ namespace NAlgo {
         double deadline;
         int thread_count;
         bool save_method_convergence;
+        /* cancels the run before the deadline, optional */
+        std::shared_ptr<CancelToken> cancel = nullptr;
+        /* set when the test is solved by a portfolio of algorithms at once */
+        std::shared_ptr<Incumbent> incumbent = nullptr;
+        ImprovementCallback on_improvement = nullptr;
     };
 
     class ISolution {
@@ -25,10 +35,39 @@ namespace NAlgo {
          */
         virtual std::string solution_name() const = 0;
 
+        /* solve gives the same tour for the same test every time it returns before the deadline */
+        virtual bool deterministic() const {
+            return false;
+        }
+
+        /* settings that change the tour besides the name and the config, "key=value,..." or empty */
+        virtual std::string hyperparameters() const {
+            return {};
+        }
+
         int solution_version() const {
             return version;
         }
+
+        void set_improvement_callback(ImprovementCallback callback) {
+            config.on_improvement = std::move(callback);
+        }
     protected:
+        /* config.deadline counted from now, every loop of the algorithm polls it */
+        Deadline start_deadline() const {
+            return Deadline(config.deadline, config.cancel);
+        }
+
+        /* the best weight so far, called at the pace of the convergence records */
+        void publish(int64_t weight, double elapsed_ms, std::function<std::vector<int>()> path = nullptr) const {
+            if (config.incumbent) {
+                config.incumbent->Offer(weight);
+            }
+            if (config.on_improvement) {
+                config.on_improvement({weight, elapsed_ms, std::move(path)});
+            }
+        }
+
         int version;
         SolutionConfig config;
     };
@@ -0,0 +1 @@
+#include "Improvement.h"
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace NAlgo {
+    /* a new best tour of a running algorithm */
+    struct Improvement {
+        int64_t weight;
+        /* since the start of the solve or optimize call */
+        double elapsed_ms;
+        /* copies the tour of this weight on request, empty if the algorithm can not provide it here */
+        std::function<std::vector<int>()> path;
+    };
+
+    /* called from the threads of the algorithm, must be thread-safe and return quickly */
+    using ImprovementCallback = std::function<void(const Improvement&)>;
+}
@@ -0,0 +1 @@
+#include "Incumbent.h"
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <lib/Deadline.h>
+
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <memory>
+
+namespace NAlgo {
+    /*
+        The best weight shared by algorithms solving one test at once. Algorithms offer their best
+        weights, BranchAndBound prunes by Weight. Reaching target cancels the shared token, and
+        every algorithm stops as at its deadline.
+     */
+    class Incumbent {
+    public:
+        Incumbent(int64_t target, std::shared_ptr<CancelToken> cancel)
+            : target(target)
+            , cancel(std::move(cancel))
+        {}
+
+        void Reset() {
+            weight.store(std::numeric_limits<int64_t>::max(), std::memory_order_relaxed);
+            cancel->Reset();
+        }
+
+        /* returns true if weight is the new best */
+        bool Offer(int64_t new_weight) {
+            int64_t current = weight.load(std::memory_order_relaxed);
+            while (new_weight < current) {
+                if (weight.compare_exchange_weak(current, new_weight, std::memory_order_relaxed)) {
+                    if (new_weight <= target) {
+                        cancel->Cancel();
+                    }
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        int64_t Weight() const {
+            return weight.load(std::memory_order_relaxed);
+        }
+
+        bool TargetReached() const {
+            return Weight() <= target;
+        }
+
+    private:
+        int64_t target;
+        std::atomic<int64_t> weight{std::numeric_limits<int64_t>::max()};
+        std::shared_ptr<CancelToken> cancel;
+    };
+}
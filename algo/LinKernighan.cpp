@@ -0,0 +1 @@
+#include "LinKernighan.h"
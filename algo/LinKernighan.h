@@ -0,0 +1,346 @@
+#pragma once
+
+#include <algo/ArrayTour.h>
+#include <algo/ConvergenceRecorder.h>
+#include <algo/IOptimizer.h>
+#include <algo/NeighbourLists.h>
+#include <algo/TwoLevelListTour.h>
+#include <lib/Deadline.h>
+
+#include <functional>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace NAlgo {
+    struct LinKernighanOpt {
+        int neighbour_count = 8;
+        /* maximal number of 2-opt steps in one variable-depth move */
+        int max_depth = 50;
+        /* number of t3 alternatives tried on the first levels, deeper levels take only the first one */
+        std::vector<int> breadth = {5, 3};
+        /* after the local optimum the rest of the deadline is spent on double-bridge kicks */
+        bool kicks = true;
+        int kick_segment = 50;
+    };
+
+    /*
+        Lin-Kernighan over neighbour lists. Every step is a 2-opt move: break (t1, t2), add (t2, t3),
+        break (t3, t4) and close with (t4, t1). The chain goes on from (t1, t4) while the partial
+        gain is positive and is rolled back to the best closing. TTour is ArrayTour or TwoLevelListTour.
+     */
+    template <class TTour>
+    class LinKernighanSearch {
+    public:
+        LinKernighanSearch(const Test& test, const NeighbourLists& neighbours, const LinKernighanOpt& opt,
+                           const std::vector<int>& path)
+            : test(test)
+            , neighbours(neighbours)
+            , opt(opt)
+            , tour(path)
+            , queued(path.size(), 0)
+        {
+            for (int v : path) {
+                push(v);
+            }
+        }
+
+        /*
+            Processes the queue of t1 until it is empty or time is out, returns the total gain.
+         */
+        int64_t Descend(const std::function<bool()>& in_time) {
+            int64_t total = 0;
+            int64_t processed = 0;
+            while (queue_head < queue.size()) {
+                if (++processed % CHECK_PERIOD == 0 && !in_time()) {
+                    break;
+                }
+                int t1 = queue[queue_head++];
+                queued[t1] = 0;
+
+                for (int side = 0; side < 2; side++) {
+                    int64_t gain = improve(t1, side == 0 ? tour.Next(t1) : tour.Prev(t1));
+                    if (gain > 0) {
+                        total += gain;
+                        push(t1);
+                        break;
+                    }
+                }
+
+                if (queue_head > queue.size() / 2 && queue_head > 1024) {
+                    queue.erase(queue.begin(), queue.begin() + queue_head);
+                    queue_head = 0;
+                }
+            }
+            return total;
+        }
+
+        bool ReachedLocalOptimum() const {
+            return queue_head == queue.size();
+        }
+
+        /*
+            Local double bridge a B C d -> a C B d of two adjacent segments of at most kick_segment
+            cities. Returns the weight change, Rollback undoes everything since.
+         */
+        int64_t Kick(std::mt19937& gen) {
+            journal.clear();
+            journaling = true;
+            queue.clear();
+            queue_head = 0;
+
+            int n = tour.Size();
+            int max_len = std::max(1, std::min(opt.kick_segment, (n - 2) / 2));
+            int len_b = 1 + gen() % max_len;
+            int len_c = 1 + gen() % max_len;
+
+            int a = gen() % n;
+            int b1 = tour.Next(a);
+            int b2 = walk(b1, len_b - 1);
+            int c1 = tour.Next(b2);
+            int c2 = walk(c1, len_c - 1);
+            int d = tour.Next(c2);
+
+            int64_t delta = test.EvalDistance(a, c1) + test.EvalDistance(c2, b1) + test.EvalDistance(b2, d)
+                - test.EvalDistance(a, b1) - test.EvalDistance(b2, c1) - test.EvalDistance(c2, d);
+
+            for (Move m : {Move{a, b1, c2, d}, Move{a, c2, c1, b2}, Move{c2, b2, b1, d}}) {
+                apply(m);
+                journal.push_back(m);
+            }
+            for (int v : {a, b1, b2, c1, c2, d}) {
+                push(v);
+            }
+            return delta;
+        }
+
+        void Rollback() {
+            while (!journal.empty()) {
+                undo(journal.back());
+                journal.pop_back();
+            }
+            journaling = false;
+        }
+
+        /* keeps the kick and the moves after it, they can no longer be rolled back */
+        void Commit() {
+            journal.clear();
+            journaling = false;
+        }
+
+        int64_t Moves() const {
+            return lk_moves;
+        }
+
+        std::vector<int> Path() const {
+            return tour.Path();
+        }
+
+    private:
+        /* 2-opt move replacing (a, b), (c, d) with (a, c), (b, d) */
+        struct Move {
+            int a, b, c, d;
+        };
+
+        int64_t improve(int t1, int t2) {
+            chain.clear();
+            added.clear();
+            best_gain = 0;
+            best_depth = 0;
+            step(1, test.EvalDistance(t1, t2), t1, t2);
+            if (best_gain <= 0) {
+                return 0;
+            }
+
+            for (const Move& m : chain) {
+                push(m.a);
+                push(m.b);
+                push(m.c);
+                push(m.d);
+                if (journaling) {
+                    journal.push_back(m);
+                }
+            }
+            lk_moves++;
+            return best_gain;
+        }
+
+        /*
+         * gain is the weight of the removed edges minus the added ones, (t1, t2) being the last
+         * removed edge. Returns true if an improving closing was found; the tour is then rolled
+         * back to the best one.
+         */
+        bool step(int level, int64_t gain, int t1, int t2) {
+            int tries = level <= (int)opt.breadth.size() ? opt.breadth[level - 1] : 1;
+
+            for (int i = 0; i < neighbours.Size() && tries > 0; i++) {
+                int t3 = neighbours.Get(t2, i);
+                int64_t g1 = gain - test.EvalDistance(t2, t3);
+                if (g1 <= 0) {
+                    break;
+                }
+                // an undone alternative may have flipped the direction of the whole tour
+                int t4 = tour.Next(t2) == t1 ? tour.Next(t3) : tour.Prev(t3);
+                if (t3 == t1 || t4 == t2 || is_added(t3, t4)) {
+                    continue;
+                }
+                tries--;
+
+                int64_t g2 = g1 + test.EvalDistance(t3, t4);
+                Move m{t2, t1, t3, t4};
+                apply(m);
+                chain.push_back(m);
+                added.emplace_back(t2, t3);
+
+                int64_t closed = g2 - test.EvalDistance(t4, t1);
+                if (closed > best_gain) {
+                    best_gain = closed;
+                    best_depth = chain.size();
+                }
+                if (level < opt.max_depth) {
+                    step(level + 1, g2, t1, t4);
+                }
+
+                if (best_gain > 0) {
+                    while ((int)chain.size() > best_depth) {
+                        undo(chain.back());
+                        chain.pop_back();
+                    }
+                    return true;
+                }
+                undo(chain.back());
+                chain.pop_back();
+                added.pop_back();
+            }
+            return false;
+        }
+
+        bool is_added(int u, int v) const {
+            for (auto [x, y] : added) {
+                if ((x == u && y == v) || (x == v && y == u)) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        int walk(int v, int steps) const {
+            while (steps-- > 0) {
+                v = tour.Next(v);
+            }
+            return v;
+        }
+
+        void push(int v) {
+            if (!queued[v]) {
+                queued[v] = 1;
+                queue.push_back(v);
+            }
+        }
+
+        /* b follows a and d follows c in the same direction */
+        void apply(const Move& m) {
+            if (tour.Next(m.a) == m.b) {
+                tour.Reverse(m.b, m.c);
+            } else {
+                tour.Reverse(m.c, m.b);
+            }
+        }
+
+        void undo(const Move& m) {
+            apply(Move{m.a, m.c, m.b, m.d});
+        }
+
+        static constexpr int64_t CHECK_PERIOD = 64;
+
+        const Test& test;
+        const NeighbourLists& neighbours;
+        const LinKernighanOpt& opt;
+        TTour tour;
+
+        std::vector<char> queued;
+        std::vector<int> queue;
+        size_t queue_head = 0;
+
+        std::vector<Move> chain;
+        std::vector<std::pair<int, int>> added;
+        int64_t best_gain = 0;
+        int best_depth = 0;
+        // moves since the last kick, recorded only while its outcome is open
+        std::vector<Move> journal;
+        bool journaling = false;
+        int64_t lk_moves = 0;
+    };
+
+    class LinKernighan : public IOptimizer {
+    public:
+        explicit LinKernighan(int version, OptimizerConfig config, LinKernighanOpt opt = {})
+            : IOptimizer(version, std::move(config))
+            , opt(std::move(opt))
+            , gen(0)
+        {}
+
+        Tour optimize(const Test& test, Tour baseline) override {
+            if (PreferTwoLevelList(test.GetVertexNum())) {
+                return run<TwoLevelListTour>(test, std::move(baseline));
+            }
+            return run<ArrayTour>(test, std::move(baseline));
+        }
+
+        std::string optimizer_name() const override  {
+            return "LinKernighan";
+        }
+
+    private:
+        template <class TTour>
+        Tour run(const Test& test, Tour baseline) {
+            Deadline deadline = start_deadline();
+            baseline.CalcTotalWeight();
+            if (test.GetVertexNum() < 8) {
+                return baseline;
+            }
+
+            NeighbourLists neighbours(test, opt.neighbour_count);
+            LinKernighanSearch<TTour> search(test, neighbours, opt, baseline.path);
+            auto in_time = [&]() {
+                return !deadline.Expired();
+            };
+
+            ConvergenceRecorder conv(config.save_method_convergence, baseline.convergence);
+            int64_t weight = baseline.TotalWeight() - search.Descend(in_time);
+            bool local_optimum = search.ReachedLocalOptimum();
+            int64_t kicks = 0;
+            int64_t accepted_kicks = 0;
+            publish(weight, deadline.Passed(), [&]() { return search.Path(); });
+            conv.Record(kicks, weight);
+
+            while (opt.kicks && local_optimum && in_time()) {
+                int64_t kick_delta = search.Kick(gen);
+                int64_t gain = search.Descend(in_time);
+                kicks++;
+
+                if (gain > kick_delta) {
+                    weight -= gain - kick_delta;
+                    accepted_kicks++;
+                    search.Commit();
+                    publish(weight, deadline.Passed(), [&]() { return search.Path(); });
+                    conv.Record(kicks, weight);
+                } else {
+                    search.Rollback();
+                }
+            }
+
+            baseline.SetPath(search.Path(), weight);
+            baseline.convergence = conv.Points();
+            baseline.statistics["LK_MOVES"] = search.Moves();
+            baseline.statistics["LOCAL_OPTIMUM"] = local_optimum;
+            baseline.statistics["KICKS"] = kicks;
+            baseline.statistics["ACCEPTED_KICKS"] = accepted_kicks;
+            baseline.statistics["ELAPSED_MS"] = deadline.Passed();
+            return baseline;
+        }
+
+        LinKernighanOpt opt;
+        std::mt19937 gen;
+    };
+}
@@ -1,64 +1,175 @@
 #pragma once
 
+#include <algo/ConvergenceRecorder.h>
+#include <algo/EucSweepRows.h>
 #include <algo/IOptimizer.h>
-#include <lib/Timer.h>
+#include <algo/NeighbourhoodSearch.h>
+#include <algo/TwoLevelListTour.h>
+#include <lib/Deadline.h>
 
+#include <climits>
 #include <iostream>
 
 namespace NAlgo {
+    enum class ELocalSearchMode : int {
+        Sweep,
+        NeighbourLists,
+        VectorSweep
+    };
+
+    struct LocalSearchOpt {
+        /*
+         * Sweep tries every (l, r) pair, NeighbourLists only moves towards the neighbour_count
+         * nearest candidates of every vertex and stops at a 2-opt local optimum.
+         * or_opt (NeighbourLists only) adds segment relocation of up to 3 cities.
+         * VectorSweep applies the same moves as Sweep, scanning r four at a time on EUC_2D tests.
+         */
+        ELocalSearchMode mode = ELocalSearchMode::Sweep;
+        int neighbour_count = 10;
+        bool or_opt = false;
+    };
+
     class LocalSearch : public IOptimizer {
     public:
-        explicit LocalSearch(int version, OptimizerConfig config)
+        explicit LocalSearch(int version, OptimizerConfig config, const LocalSearchOpt& opt = {})
             : IOptimizer(version, std::move(config))
+            , opt(opt)
         {}
 
         Tour optimize(const Test& test, Tour baseline) override {
-            baseline.CalcTotalWeight();
-            Tour best_tour = baseline;
-            Timer timer;
+            if (opt.mode == ELocalSearchMode::NeighbourLists) {
+                if (PreferTwoLevelList(test.GetVertexNum())) {
+                    return optimize_with_neighbours<TwoLevelListTour>(test, std::move(baseline));
+                }
+                return optimize_with_neighbours<ArrayTour>(test, std::move(baseline));
+            }
+            if (opt.mode == ELocalSearchMode::VectorSweep && EucSweepRows::Supports(test)) {
+                return optimize_vector_sweep(test, std::move(baseline));
+            }
 
-            int64_t currentWeight = baseline.TotalWeight();
+            // only improving moves are applied, so the current tour is always the best one
+            baseline.CalcTotalWeight();
+            Deadline deadline = start_deadline();
 
-            int iter = 0;
+            int64_t iter = 0;
+            ConvergenceRecorder conv(config.save_method_convergence, baseline.convergence);
             bool ok = true;
-            while (timer.Passed() < config.deadline && ok) {
+            while (ok && !deadline.Expired()) {
                 for (int l = 0; l < test.GetVertexNum() && ok; l++) {
                     for (int r = l + 1; r < test.GetVertexNum() && ok; r++) {
-                        int prev = (l - 1 + test.GetVertexNum()) % test.GetVertexNum();
-                        int next = (r + 1) % test.GetVertexNum();
-                        std::vector<int> &p = baseline.path;
-                        if (
-                                test.EvalDistance(p[prev], p[r]) + test.EvalDistance(p[l], p[next]) <
-                                test.EvalDistance(p[prev], p[l]) + test.EvalDistance(p[r], p[next])
-                                ) {
-                            currentWeight -= test.EvalDistance(p[prev], p[l]) + test.EvalDistance(p[r], p[next]);
-                            std::reverse(p.begin() + l, p.begin() + r + 1);
-                            currentWeight += test.EvalDistance(p[prev], p[l]) + test.EvalDistance(p[r], p[next]);
-                        }
-                        if (currentWeight < best_tour.TotalWeight()) {
-                            best_tour = baseline;
-                            best_tour.CalcTotalWeight();
-                            assert(best_tour.TotalWeight() == currentWeight); // fixme checking for first time
+                        if (baseline.TwoOptDelta(l, r) < 0) {
+                            baseline.ApplyTwoOpt(l, r);
                         }
 
                         iter++;
-                        if (iter % 5000 == 0) {
-                            if(timer.Passed() > config.deadline) {
-                                ok = false;
-                            }
-                        }
+                        ok = !deadline.Expired();
                     }
+                    publish(baseline.TotalWeight(), deadline.Passed(), [&]() { return baseline.path; });
+                    conv.Record(iter, baseline.TotalWeight());
                 }
 
             }
 
-            return best_tour;
+            baseline.convergence = conv.Points();
+            baseline.statistics["EVALUATED_MOVES"] = iter;
+            baseline.statistics["ELAPSED_MS"] = deadline.Passed();
+            return baseline;
         }
 
         std::string optimizer_name() const override  {
+            if (opt.mode == ELocalSearchMode::VectorSweep) {
+                return "VectorLocalSearch";
+            }
+            if (opt.mode == ELocalSearchMode::NeighbourLists) {
+                return opt.or_opt ? "OrOpt" : "NeighbourTwoOpt";
+            }
             return "LocalSearch";
         }
+
+        bool deterministic() const override {
+            return true;
+        }
     private:
+        LocalSearchOpt opt;
+
+        /* same visiting order and moves as the sweep, rows of r are filtered by EucSweepRows */
+        Tour optimize_vector_sweep(const Test& test, Tour baseline) {
+            baseline.CalcTotalWeight();
+            Deadline deadline = start_deadline();
 
+            int n = test.GetVertexNum();
+            EucSweepRows rows(test, baseline.path);
+            int64_t iter = 0;
+            ConvergenceRecorder conv(config.save_method_convergence, baseline.convergence);
+            bool ok = true;
+            while (ok && !deadline.Expired()) {
+                for (int l = 0; l < n && ok; l++) {
+                    for (int r = l + 1; r < n && ok;) {
+                        int end = std::min(n, r + ROW_BLOCK);
+                        int found = rows.FindCandidate(l, r, end);
+                        iter += found - r;
+                        r = found;
+                        if (found < end) {
+                            iter++;
+                            r++;
+                            if (baseline.TwoOptDelta(l, found) < 0) {
+                                baseline.ApplyTwoOpt(l, found);
+                                // ApplyTwoOpt reverses the shorter of [l, found] and its complement
+                                int len = found - l + 1;
+                                if (2 * len > n) {
+                                    rows.Refresh(baseline.path, (found + 1) % n, n - len);
+                                } else {
+                                    rows.Refresh(baseline.path, l, len);
+                                }
+                            }
+                        }
+                        ok = !deadline.Expired();
+                    }
+                    publish(baseline.TotalWeight(), deadline.Passed(), [&]() { return baseline.path; });
+                    conv.Record(iter, baseline.TotalWeight());
+                }
+            }
+
+            baseline.convergence = conv.Points();
+            baseline.statistics["EVALUATED_MOVES"] = iter;
+            baseline.statistics["ELAPSED_MS"] = deadline.Passed();
+            return baseline;
+        }
+
+        static constexpr int ROW_BLOCK = 1024;
+
+        template <class TTour>
+        Tour optimize_with_neighbours(const Test& test, Tour baseline) {
+            Deadline deadline = start_deadline();
+            baseline.CalcTotalWeight();
+            int64_t start_weight = baseline.TotalWeight();
+
+            NeighbourLists neighbours(test, opt.neighbour_count);
+            NeighbourhoodSearch<TTour> search(test, neighbours);
+            search.SetOrOpt(opt.or_opt);
+
+            int64_t iter = 0;
+            ConvergenceRecorder conv(config.save_method_convergence, baseline.convergence);
+            search.SetMonitor([&](int64_t delta) {
+                iter++;
+                // the path is inside the search until it returns
+                publish(start_weight + delta, deadline.Passed());
+                conv.Record(iter, start_weight + delta);
+                return !deadline.Expired();
+            });
+            std::vector<int> path = std::move(baseline.path);
+            int64_t delta = search.Improve(path, LLONG_MAX);
+            conv.Record(iter, start_weight + delta);
+
+            baseline.SetPath(std::move(path), start_weight + delta);
+            baseline.convergence = conv.Points();
+            baseline.statistics["TWO_OPT_MOVES"] = search.Moves().two_opt;
+            if (opt.or_opt) {
+                baseline.statistics["OR_OPT_MOVES"] = search.Moves().or_opt;
+            }
+            baseline.statistics["LOCAL_OPTIMUM"] = search.ReachedLocalOptimum();
+            baseline.statistics["ELAPSED_MS"] = deadline.Passed();
+            return baseline;
+        }
     };
 }
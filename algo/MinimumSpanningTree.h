@@ -3,7 +3,7 @@
 #include <algo/ISolution.h>
 #include <algorithm>
 #include <numeric>
-#include <lib/Timer.h>
+#include <lib/Deadline.h>
 
 
 namespace NAlgo {
@@ -14,6 +14,7 @@ namespace NAlgo {
         {}
 
         Tour solve(const Test& test) override {
+            Deadline deadline = start_deadline();
             Tour tour(test);
             int64_t answer = LONG_LONG_MAX;
 
@@ -26,14 +27,18 @@ namespace NAlgo {
             if (test.GetVertexNum() < 7500) {
                 auto min_spanning_tree = find_min_spanning_tree(test, tour);
 
-                for (int i = 0; i < test.GetVertexNum(); i++) {
-                    Tour candidate(test);
-                    dfs(i, -1, min_spanning_tree, candidate);
-                    candidate.CalcTotalWeight();
-
-                    if (candidate.TotalWeight() < answer) {
-                        answer = candidate.TotalWeight();
-                        tour = candidate;
+                std::vector<int> candidate;
+                candidate.reserve(test.GetVertexNum());
+                // every start vertex gives a tour, after the deadline the best of the tried ones is kept
+                for (int i = 0; i < test.GetVertexNum() && (i == 0 || !deadline.Expired()); i++) {
+                    candidate.clear();
+                    int64_t weight = 0;
+                    dfs(test, i, -1, min_spanning_tree, candidate, weight);
+                    weight += test.EvalDistance(candidate.back(), candidate.front());
+
+                    if (weight < answer) {
+                        answer = weight;
+                        tour.SetPath(candidate, weight);
                     }
                 }
             }
@@ -45,12 +50,21 @@ namespace NAlgo {
             return "MinimumSpanningTree";
         }
 
+        bool deterministic() const override {
+            return true;
+        }
+
     private:
-        void dfs(int u, int parent, const std::vector<std::vector<int>>& adj_list, Tour& tour) {
-            tour.path.push_back(u);
+        /* weight accumulates the edges of the path as it is built */
+        void dfs(const Test& test, int u, int parent, const std::vector<std::vector<int>>& adj_list,
+                 std::vector<int>& path, int64_t& weight) {
+            if (!path.empty()) {
+                weight += test.EvalDistance(path.back(), u);
+            }
+            path.push_back(u);
             for (auto v : adj_list[u]) {
                 if (v != parent) {
-                    dfs(v, u, adj_list, tour);
+                    dfs(test, v, u, adj_list, path, weight);
                 }
             }
         }
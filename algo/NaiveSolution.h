@@ -2,7 +2,7 @@
 
 #include <algo/ISolution.h>
 #include <algorithm>
-#include <lib/Timer.h>
+#include <lib/Deadline.h>
 #include <random>
 #include <lib/ThreadPool.h>
 
@@ -19,8 +19,7 @@ namespace NAlgo {
             std::vector<std::future<Tour>> results;
             for (int i = 0; i < config.thread_count; i++) {
                 results.emplace_back(
-                    pool.enqueue([i, &test, deadline=config.deadline](){
-                        Timer timer;
+                    pool.enqueue([i, &test, budget = config.deadline, cancel = config.cancel](){
                         Tour tour(test);
                         int64_t answer = LONG_LONG_MAX;
 
@@ -31,19 +30,16 @@ namespace NAlgo {
 
                         std::mt19937 gen(i);
 
-                        timer.Reset();
+                        Deadline deadline(budget, cancel);
                         do {
-                            Tour candidate(test);
-                            candidate.path = v;
-                            candidate.CalcTotalWeight();
-
-                            if (candidate.TotalWeight() < answer) {
-                                tour = candidate;
-                                answer = candidate.TotalWeight();
+                            int64_t weight = Tour::PathWeight(test, v);
+                            if (weight < answer) {
+                                tour.SetPath(v, weight);
+                                answer = weight;
                             }
 
                             std::shuffle(v.begin(), v.end(), gen);
-                        } while(timer.Passed() < deadline);
+                        } while(!deadline.Expired());
 
                         return tour;
                     })
@@ -2,6 +2,10 @@
 
 #include <algo/ISolution.h>
 
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
 namespace NAlgo {
     class NearestNeighbour : public ISolution {
     public:
@@ -10,6 +14,7 @@ namespace NAlgo {
         {}
 
         Tour solve(const Test& test) override {
+            Deadline deadline = start_deadline();
             int vertex = 0;
             Tour tour(test);
 
@@ -17,7 +22,7 @@ namespace NAlgo {
             tour.path.push_back(vertex);
             used[vertex] = true;
 
-            for (int i = 0; i < test.GetVertexNum() - 1; i++) {
+            for (int i = 0; i < test.GetVertexNum() - 1 && !deadline.Expired(); i++) {
                 int opt_next_vertex = -1;
                 for (int j = 0; j < test.GetVertexNum(); j++) {
                     if (!used[j] && (opt_next_vertex == -1 || test.EvalDistance(vertex, j) < test.EvalDistance(vertex, opt_next_vertex)))  {
@@ -29,6 +34,22 @@ namespace NAlgo {
                 tour.path.push_back(vertex);
             }
 
+            // out of time: the rest of the cities are still taken greedily, from a grid of the unvisited
+            // points instead of a full scan; without coordinates they follow in index order
+            int appended = test.GetVertexNum() - (int)tour.path.size();
+            if (appended > 0) {
+                if (test.HasPoints() && test.GetWeightType() != "GEO") {
+                    append_with_grid(test, used, tour.path);
+                } else {
+                    for (int v = 0; v < test.GetVertexNum(); v++) {
+                        if (!used[v]) {
+                            tour.path.push_back(v);
+                        }
+                    }
+                }
+                tour.statistics["UNVISITED_APPENDED"] = appended;
+            }
+
             tour.CalcTotalWeight();
             return tour;
         }
@@ -36,5 +57,92 @@ namespace NAlgo {
         std::string solution_name() const override  {
             return "NearestNeighbour";
         }
+
+        bool deterministic() const override {
+            return true;
+        }
+
+    private:
+        /*
+         * Nearest neighbour over the unvisited points bucketed into a uniform grid of about two points
+         * per cell: cells are scanned in rings around the last city until the ring is farther than
+         * the best candidate. The grid is rebuilt once three quarters of its points are taken, so
+         * the rings stay short as the rest thins out.
+         */
+        static void append_with_grid(const Test& test, std::vector<char>& used, std::vector<int>& path) {
+            const auto& points = test.GetPoints();
+            std::vector<int> rest;
+            for (int v = 0; v < test.GetVertexNum(); v++) {
+                if (!used[v]) {
+                    rest.push_back(v);
+                }
+            }
+
+            std::vector<int> position(test.GetVertexNum());
+            while (!rest.empty()) {
+                long double min_x = points[rest[0]].x, max_x = min_x;
+                long double min_y = points[rest[0]].y, max_y = min_y;
+                for (int v : rest) {
+                    min_x = std::min(min_x, points[v].x);
+                    max_x = std::max(max_x, points[v].x);
+                    min_y = std::min(min_y, points[v].y);
+                    max_y = std::max(max_y, points[v].y);
+                }
+                int side = std::max(1, (int)std::sqrt(rest.size() / 2.0));
+                long double cell_w = std::max((max_x - min_x) / side, (long double)1e-9);
+                long double cell_h = std::max((max_y - min_y) / side, (long double)1e-9);
+                auto cell_of = [&](long double c, long double lo, long double size) {
+                    return std::min(side - 1, std::max(0, (int)((c - lo) / size)));
+                };
+
+                std::vector<std::vector<int>> cells(side * side);
+                for (int v : rest) {
+                    auto& cell = cells[cell_of(points[v].y, min_y, cell_h) * side + cell_of(points[v].x, min_x, cell_w)];
+                    position[v] = cell.size();
+                    cell.push_back(v);
+                }
+
+                size_t left = rest.size();
+                while (left > 0 && left * 4 > rest.size()) {
+                    const Point& p = points[path.back()];
+                    int cx = cell_of(p.x, min_x, cell_w);
+                    int cy = cell_of(p.y, min_y, cell_h);
+                    int best = -1;
+                    long double best_distance = 0;
+                    for (int ring = 0; ring <= side; ring++) {
+                        for (int y = std::max(0, cy - ring); y <= std::min(side - 1, cy + ring); y++) {
+                            int step = (y == cy - ring || y == cy + ring) ? 1 : 2 * ring;
+                            for (int x = cx - ring; x <= cx + ring; x += std::max(step, 1)) {
+                                if (x < 0 || x >= side) {
+                                    continue;
+                                }
+                                for (int u : cells[y * side + x]) {
+                                    long double dx = p.x - points[u].x, dy = p.y - points[u].y;
+                                    if (best == -1 || dx * dx + dy * dy < best_distance) {
+                                        best = u;
+                                        best_distance = dx * dx + dy * dy;
+                                    }
+                                }
+                            }
+                        }
+                        // everything outside the scanned square is at least ring * cell away
+                        long double reach = ring * std::min(cell_w, cell_h);
+                        if (best != -1 && best_distance <= reach * reach) {
+                            break;
+                        }
+                    }
+
+                    auto& cell = cells[cell_of(points[best].y, min_y, cell_h) * side + cell_of(points[best].x, min_x, cell_w)];
+                    position[cell.back()] = position[best];
+                    cell[position[best]] = cell.back();
+                    cell.pop_back();
+                    used[best] = true;
+                    path.push_back(best);
+                    left--;
+                }
+
+                rest.erase(std::remove_if(rest.begin(), rest.end(), [&](int v) { return used[v]; }), rest.end());
+            }
+        }
     };
 }
\ No newline at end of file
@@ -0,0 +1 @@
+#include "NeighbourLists.h"
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <algo/Test.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace NAlgo {
+    /*
+     * K nearest candidate neighbours of every vertex, sorted by distance.
+     * Coordinate tests are bucketed into a uniform grid so the lists of pla85900 are built
+     * in well under a second; GEO and EXPLICIT tests fall back to a full scan.
+     */
+    class NeighbourLists {
+    public:
+        NeighbourLists(const Test& test, int count)
+            : vertex_num(test.GetVertexNum())
+            , count(std::max(0, std::min(count, test.GetVertexNum() - 1)))
+        {
+            neighbours.resize((size_t)vertex_num * this->count);
+            if (this->count == 0) {
+                return;
+            }
+            if (test.HasPoints() && test.GetWeightType() != "GEO") {
+                build_with_grid(test);
+            } else {
+                build_with_scan(test);
+            }
+        }
+
+        int Size() const {
+            return count;
+        }
+
+        int Get(int v, int i) const {
+            return neighbours[(size_t)v * count + i];
+        }
+
+    private:
+        void build_with_scan(const Test& test) {
+            std::vector<std::pair<int64_t, int>> candidates;
+            for (int v = 0; v < vertex_num; v++) {
+                candidates.clear();
+                for (int u = 0; u < vertex_num; u++) {
+                    if (u != v) {
+                        candidates.emplace_back(test.EvalDistance(v, u), u);
+                    }
+                }
+                std::partial_sort(candidates.begin(), candidates.begin() + count, candidates.end());
+                for (int i = 0; i < count; i++) {
+                    neighbours[(size_t)v * count + i] = candidates[i].second;
+                }
+            }
+        }
+
+        void build_with_grid(const Test& test) {
+            long double min_x = test.GetPoint(0).x, max_x = min_x;
+            long double min_y = test.GetPoint(0).y, max_y = min_y;
+            for (int v = 0; v < vertex_num; v++) {
+                auto p = test.GetPoint(v);
+                min_x = std::min(min_x, p.x);
+                max_x = std::max(max_x, p.x);
+                min_y = std::min(min_y, p.y);
+                max_y = std::max(max_y, p.y);
+            }
+
+            // about two points per cell
+            int side = std::max(1, (int)std::sqrt(vertex_num / 2.0));
+            long double cell_w = std::max((max_x - min_x) / side, (long double)1e-9);
+            long double cell_h = std::max((max_y - min_y) / side, (long double)1e-9);
+
+            auto cell_of = [&](long double c, long double lo, long double size) {
+                return std::min(side - 1, std::max(0, (int)((c - lo) / size)));
+            };
+
+            std::vector<int> cell_start(side * side + 1, 0);
+            std::vector<int> cell_index(vertex_num);
+            for (int v = 0; v < vertex_num; v++) {
+                auto p = test.GetPoint(v);
+                cell_index[v] = cell_of(p.y, min_y, cell_h) * side + cell_of(p.x, min_x, cell_w);
+                cell_start[cell_index[v] + 1]++;
+            }
+            for (int c = 0; c < side * side; c++) {
+                cell_start[c + 1] += cell_start[c];
+            }
+            std::vector<int> cell_items(vertex_num);
+            std::vector<int> fill(cell_start.begin(), cell_start.end() - 1);
+            for (int v = 0; v < vertex_num; v++) {
+                cell_items[fill[cell_index[v]]++] = v;
+            }
+
+            std::vector<std::pair<long double, int>> candidates;
+            for (int v = 0; v < vertex_num; v++) {
+                auto p = test.GetPoint(v);
+                int cx = cell_of(p.x, min_x, cell_w);
+                int cy = cell_of(p.y, min_y, cell_h);
+
+                candidates.clear();
+                for (int ring = 0; ring <= side; ring++) {
+                    for (int y = cy - ring; y <= cy + ring; y++) {
+                        if (y < 0 || y >= side) {
+                            continue;
+                        }
+                        int step = (y == cy - ring || y == cy + ring) ? 1 : 2 * ring;
+                        for (int x = cx - ring; x <= cx + ring; x += std::max(step, 1)) {
+                            if (x < 0 || x >= side) {
+                                continue;
+                            }
+                            int c = y * side + x;
+                            for (int k = cell_start[c]; k < cell_start[c + 1]; k++) {
+                                int u = cell_items[k];
+                                if (u != v) {
+                                    auto q = test.GetPoint(u);
+                                    long double dx = p.x - q.x, dy = p.y - q.y;
+                                    candidates.emplace_back(dx * dx + dy * dy, u);
+                                }
+                            }
+                        }
+                    }
+
+                    // everything outside the scanned square is at least ring * cell away
+                    if ((int)candidates.size() >= count) {
+                        std::nth_element(candidates.begin(), candidates.begin() + count - 1, candidates.end());
+                        long double reach = ring * std::min(cell_w, cell_h);
+                        if (candidates[count - 1].first <= reach * reach) {
+                            break;
+                        }
+                    }
+                }
+
+                std::partial_sort(candidates.begin(), candidates.begin() + count, candidates.end());
+                for (int i = 0; i < count; i++) {
+                    neighbours[(size_t)v * count + i] = candidates[i].second;
+                }
+            }
+        }
+
+        int vertex_num;
+        int count;
+        std::vector<int> neighbours;
+    };
+}
@@ -0,0 +1 @@
+#include "NeighbourhoodSearch.h"
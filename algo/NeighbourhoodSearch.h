@@ -0,0 +1,252 @@
+#pragma once
+
+#include <algo/ArrayTour.h>
+#include <algo/NeighbourLists.h>
+#include <algo/Test.h>
+
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+namespace NAlgo {
+    /*
+     * 2-opt restricted to candidate neighbour lists with a queue of "dirty" vertices
+     * (don't-look bits). TTour is the tour representation (ArrayTour or TwoLevelListTour).
+     * With SetOrOpt(true) a vertex without an improving 2-opt move is also tried as an end of
+     * a relocated segment (Or-opt), which makes the search a variable-neighbourhood descent.
+     */
+    template <class TTour = ArrayTour>
+    class NeighbourhoodSearch {
+    public:
+        struct MoveCounts {
+            int64_t two_opt = 0;
+            int64_t or_opt = 0;
+        };
+
+        NeighbourhoodSearch(const Test& test, const NeighbourLists& neighbours)
+            : test(test)
+            , neighbours(neighbours)
+        {}
+
+        /*
+         * monitor is called every MONITOR_PERIOD processed vertices with the weight change so far;
+         * returning false stops the search.
+         */
+        void SetMonitor(std::function<bool(int64_t)> monitor) {
+            this->monitor = std::move(monitor);
+        }
+
+        void SetOrOpt(bool enabled) {
+            or_opt = enabled;
+        }
+
+        bool ReachedLocalOptimum() const {
+            return local_optimum;
+        }
+
+        const MoveCounts& Moves() const {
+            return moves;
+        }
+
+        /*
+            Improves path until no move improves it or budget candidate checks are spent.
+            Returns the weight change (<= 0).
+         */
+        int64_t Improve(std::vector<int>& path, int64_t budget, int start = 0) {
+            int n = path.size();
+            if (n < 5) {
+                return 0;
+            }
+
+            TTour tour(path);
+
+            queued.assign(n, 1);
+            queue.clear();
+            queue_head = 0;
+            for (int i = 0; i < n; i++) {
+                queue.push_back(path[(start + i) % n]);
+            }
+
+            int64_t delta = 0;
+            int64_t processed = 0;
+            while (queue_head < queue.size() && budget > 0) {
+                int a = queue[queue_head++];
+                queued[a] = 0;
+
+                int64_t gain = improve_vertex(tour, a, budget);
+                if (gain == 0 && or_opt) {
+                    gain = relocate_segment(tour, a, budget);
+                }
+                if (gain < 0) {
+                    delta += gain;
+                }
+
+                if (monitor && ++processed % MONITOR_PERIOD == 0 && !monitor(delta)) {
+                    break;
+                }
+
+                if (queue_head > queue.size() / 2 && queue_head > 1024) {
+                    queue.erase(queue.begin(), queue.begin() + queue_head);
+                    queue_head = 0;
+                }
+            }
+            local_optimum = queue_head == queue.size();
+            path = tour.Path();
+            return delta;
+        }
+
+    private:
+        void push(int v) {
+            if (!queued[v]) {
+                queued[v] = 1;
+                queue.push_back(v);
+            }
+        }
+
+        int64_t improve_vertex(TTour& tour, int a, int64_t& budget) {
+            for (int dir = 0; dir < 2; dir++) {
+                int b = dir == 0 ? tour.Next(a) : tour.Prev(a);
+                int64_t d_ab = test.EvalDistance(a, b);
+
+                for (int i = 0; i < neighbours.Size() && budget > 0; i++, budget--) {
+                    int c = neighbours.Get(a, i);
+                    int64_t d_ac = test.EvalDistance(a, c);
+                    if (d_ac >= d_ab) {
+                        break;
+                    }
+
+                    int d = dir == 0 ? tour.Next(c) : tour.Prev(c);
+                    if (c == b || d == a) {
+                        continue;
+                    }
+
+                    int64_t delta = d_ac + test.EvalDistance(b, d) - d_ab - test.EvalDistance(c, d);
+                    if (delta < 0) {
+                        move(tour, a, b, c);
+                        push(a);
+                        push(b);
+                        push(c);
+                        push(d);
+                        moves.two_opt++;
+                        return delta;
+                    }
+                }
+            }
+            return 0;
+        }
+
+        /*
+            Or-opt: a is the first (side 0) or the last (side 1) city of a segment s1..s2 of up to
+            MAX_SEGMENT cities, which is cut out and inserted next to a candidate neighbour c,
+            reversed if that puts a next to c.
+         */
+        int64_t relocate_segment(TTour& tour, int a, int64_t& budget) {
+            for (int side = 0; side < 2; side++) {
+                int segment[MAX_SEGMENT];
+                int s1 = a, s2 = a;
+                for (int len = 1; len <= MAX_SEGMENT; len++) {
+                    if (len > 1) {
+                        if (side == 0) {
+                            s2 = tour.Next(s2);
+                        } else {
+                            s1 = tour.Prev(s1);
+                        }
+                    }
+                    segment[len - 1] = side == 0 ? s2 : s1;
+                    auto inside = [&](int v) {
+                        return std::find(segment, segment + len, v) != segment + len;
+                    };
+
+                    int p = tour.Prev(s1);
+                    int nx = tour.Next(s2);
+                    int64_t removal_gain = test.EvalDistance(p, s1) + test.EvalDistance(s2, nx) - test.EvalDistance(p, nx);
+                    if (removal_gain <= 0) {
+                        continue;
+                    }
+                    int other = a == s1 ? s2 : s1;
+
+                    for (int i = 0; i < neighbours.Size() && budget > 0; i++, budget--) {
+                        int c = neighbours.Get(a, i);
+                        int64_t d_ac = test.EvalDistance(a, c);
+                        if (d_ac >= removal_gain) {
+                            break;
+                        }
+                        if (inside(c)) {
+                            continue;
+                        }
+
+                        for (int dir = 0; dir < 2; dir++) {
+                            // the segment goes between u and w = succ(u), a next to c
+                            int u = dir == 0 ? c : tour.Prev(c);
+                            int w = dir == 0 ? tour.Next(c) : c;
+                            if (inside(u) || inside(w) || (u == nx && w == p)) {
+                                continue;
+                            }
+
+                            int64_t delta = d_ac + test.EvalDistance(other, dir == 0 ? w : u)
+                                - test.EvalDistance(u, w) - removal_gain;
+                            if (delta < 0) {
+                                relocate(tour, p, s1, s2, nx, u, w, dir == 0 ? a : other);
+                                push(p);
+                                push(nx);
+                                push(s1);
+                                push(s2);
+                                push(u);
+                                push(w);
+                                moves.or_opt++;
+                                return delta;
+                            }
+                        }
+                    }
+                }
+            }
+            return 0;
+        }
+
+        /*
+         * p s1..s2 nx ... u w -> p nx ... u x..y w, where x is s1 or s2. Done as two or three
+         * 2-opt moves so that it does not depend on the orientation of the path.
+         */
+        void relocate(TTour& tour, int p, int s1, int s2, int nx, int u, int w, int x) {
+            bool keep_orientation = x == s1;
+            if (w == p) {
+                std::swap(p, nx);
+                std::swap(s1, s2);
+                std::swap(u, w);
+            }
+            move(tour, p, s1, u); // p u ... nx s2..s1 w
+            if (u != nx) {
+                move(tour, p, u, nx); // p nx ... u s2..s1 w
+            }
+            if (keep_orientation) {
+                move(tour, u, s2, s1); // p nx ... u s1..s2 w
+            }
+        }
+
+        /*
+         * Replaces edges (a, b), (c, d) with (a, c), (b, d), where b follows a and d, the city after c
+         * in the same direction, is implied. succ: a b ... c d -> a c ... b d; pred: d c ... b a -> d b ... c a
+         */
+        void move(TTour& tour, int a, int b, int c) {
+            if (tour.Next(a) == b) {
+                tour.Reverse(b, c);
+            } else {
+                tour.Reverse(c, b);
+            }
+        }
+
+        static constexpr int64_t MONITOR_PERIOD = 1024;
+        static constexpr int MAX_SEGMENT = 3;
+
+        const Test& test;
+        const NeighbourLists& neighbours;
+        std::function<bool(int64_t)> monitor;
+        MoveCounts moves;
+        bool or_opt = false;
+        bool local_optimum = false;
+
+        std::vector<char> queued;
+        std::vector<int> queue;
+        size_t queue_head = 0;
+    };
+}
@@ -0,0 +1 @@
+#include "OptimizerPipeline.h"
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <algo/ConvergenceRecorder.h>
+#include <algo/IOptimizer.h>
+#include <lib/Timer.h>
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace NAlgo {
+    struct PipelineStage {
+        std::unique_ptr<IOptimizer> optimizer;
+        /* milliseconds if > 1, share of the pipeline deadline if in (0, 1], a share of the rest if <= 0 */
+        double budget = 0;
+    };
+
+    /* what one stage did in the last optimize call */
+    struct StageReport {
+        std::string name;
+        double budget_ms;
+        double elapsed_ms;
+        int64_t start_weight;
+        int64_t end_weight;
+    };
+
+    /*
+        Optimizers run one after another under a common deadline. Stage budgets are given in ms or
+        as a share of the deadline, must fit it and leave time to the stages without one, which share
+        the rest equally. Stage i ends by the sum of the budgets of stages 0..i, so time left by one
+        stage goes to the next. With several stages their statistics get the STAGE<i>_ prefix.
+     */
+    class OptimizerPipeline : public IOptimizer {
+    public:
+        OptimizerPipeline(int version, OptimizerConfig config, std::vector<PipelineStage> stages)
+            : IOptimizer(version, std::move(config))
+            , stages(std::move(stages))
+        {
+            // a spec that does not fit the deadline fails here rather than at the first run
+            split_budget();
+        }
+
+        Tour optimize(const Test& test, Tour baseline) override {
+            Timer timer;
+            std::vector<double> budgets = split_budget();
+            reports.clear();
+
+            baseline.CalcTotalWeight();
+            double planned_end = 0;
+            for (size_t i = 0; i < stages.size(); i++) {
+                planned_end += budgets[i];
+                double start = timer.Passed();
+                IOptimizer& optimizer = *stages[i].optimizer;
+                optimizer.set_deadline(std::max(0.0, planned_end - start));
+                optimizer.set_improvement_callback(shifted(start));
+
+                StageReport report{optimizer.optimizer_name(), budgets[i], 0, baseline.TotalWeight(), 0};
+                size_t recorded = baseline.convergence.size();
+                std::map<std::string, double> statistics;
+                if (stages.size() > 1) {
+                    statistics.swap(baseline.statistics);
+                }
+
+                baseline = optimizer.optimize(test, std::move(baseline));
+
+                report.elapsed_ms = timer.Passed() - start;
+                report.end_weight = baseline.TotalWeight();
+                ShiftConvergence(baseline.convergence, recorded, start);
+                if (stages.size() > 1) {
+                    std::string prefix = "STAGE" + std::to_string(i) + "_";
+                    for (const auto& [name, value] : baseline.statistics) {
+                        statistics[prefix + name] = value;
+                    }
+                    statistics[prefix + "MS"] = report.elapsed_ms;
+                    statistics[prefix + "GAIN"] = report.start_weight - report.end_weight;
+                    baseline.statistics = std::move(statistics);
+                }
+                reports.push_back(std::move(report));
+            }
+            return baseline;
+        }
+
+        std::string optimizer_name() const override  {
+            std::string name;
+            for (const auto& stage : stages) {
+                name += (name.empty() ? "" : ",") + stage.optimizer->optimizer_name();
+            }
+            return name;
+        }
+
+        bool deterministic() const override {
+            return std::all_of(stages.begin(), stages.end(), [](const PipelineStage& stage) {
+                return stage.optimizer->deterministic();
+            });
+        }
+
+        const std::vector<StageReport>& Reports() const {
+            return reports;
+        }
+
+    private:
+        /* the callback of the pipeline with the times of a stage that started at start */
+        ImprovementCallback shifted(double start) const {
+            if (!config.on_improvement) {
+                return nullptr;
+            }
+            return [callback = config.on_improvement, start](const Improvement& improvement) {
+                callback({improvement.weight, improvement.elapsed_ms + start, improvement.path});
+            };
+        }
+
+        std::vector<double> split_budget() const {
+            std::vector<double> budgets(stages.size());
+            double assigned = 0;
+            int unassigned = 0;
+            for (size_t i = 0; i < stages.size(); i++) {
+                double budget = stages[i].budget;
+                budgets[i] = budget > 1 ? budget : budget > 0 ? budget * config.deadline : 0;
+                assigned += budgets[i];
+                unassigned += budget <= 0;
+            }
+            // stages without a budget need some of the deadline left to them
+            double slack = config.deadline * 1e-9;
+            if (assigned > config.deadline + slack || (unassigned > 0 && assigned > 0 && assigned >= config.deadline - slack)) {
+                std::ostringstream message;
+                message << "Optimizer stage budgets of " << assigned << " ms do not fit the deadline of "
+                        << config.deadline << " ms";
+                throw std::runtime_error(message.str());
+            }
+            double rest = std::max(0.0, config.deadline - assigned);
+            for (size_t i = 0; i < stages.size(); i++) {
+                if (stages[i].budget <= 0) {
+                    budgets[i] = rest / unassigned;
+                }
+            }
+            return budgets;
+        }
+
+        std::vector<PipelineStage> stages;
+        std::vector<StageReport> reports;
+    };
+}
@@ -0,0 +1 @@
+#include "ParallelTempering.h"
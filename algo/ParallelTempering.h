@@ -0,0 +1,215 @@
+#pragma once
+
+#include <algo/ArrayTour.h>
+#include <algo/BestTourTracker.h>
+#include <algo/ConvergenceRecorder.h>
+#include <algo/IOptimizer.h>
+#include <algo/NeighbourLists.h>
+#include <algo/TwoLevelListTour.h>
+#include <lib/ThreadPool.h>
+#include <lib/Deadline.h>
+
+#include <cmath>
+#include <future>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace NAlgo {
+    struct ParallelTemperingOpt {
+        int neighbour_count = 8;
+        /* temperatures are spaced geometrically between these fractions of the mean edge of the start tour */
+        double t_min = 0.02;
+        double t_max = 0.5;
+        /* proposals of every chain between two exchange rounds, a chain stops early at the deadline */
+        int64_t epoch = 20000;
+        /* 0 means one chain per thread, at least two */
+        int replicas = 0;
+    };
+
+    /*
+        Annealing at a fixed temperature: 2-opt moves (a, Next(a)), (c, Next(c)) with c from the
+        neighbour list of a, accepted by the Metropolis criterion.
+     */
+    template <class TTour>
+    class TemperingChain {
+    public:
+        TemperingChain(const Test& test, const NeighbourLists& neighbours, const std::vector<int>& path,
+                       int64_t weight, uint32_t seed, const Deadline& deadline)
+            : test(test)
+            , neighbours(neighbours)
+            , tour(path)
+            , weight(weight)
+            , gen(seed)
+            , best([this]() -> std::vector<int> { return tour.Path(); }, weight, path.size())
+            , deadline(deadline)
+        {}
+
+        void Run(double T, int64_t proposals) {
+            int n = tour.Size();
+            std::uniform_real_distribution<double> unit(0, 1);
+            for (int64_t i = 0; i < proposals && !deadline.Expired(); i++) {
+                int a = gen() % n;
+                int c = neighbours.Get(a, gen() % neighbours.Size());
+                int b = tour.Next(a);
+                int d = tour.Next(c);
+                if (c == b || d == a) {
+                    continue;
+                }
+                int64_t delta = test.EvalDistance(a, c) + test.EvalDistance(b, d)
+                    - test.EvalDistance(a, b) - test.EvalDistance(c, d);
+                if (delta <= 0 || unit(gen) < std::exp(-delta / T)) {
+                    tour.Reverse(b, c);
+                    weight += delta;
+                    best.Record({a, b, c, d}, weight);
+                    accepted++;
+                }
+            }
+        }
+
+        int64_t Weight() const {
+            return weight;
+        }
+
+        int64_t Accepted() const {
+            return accepted;
+        }
+
+        const BestTourTracker& Best() const {
+            return best;
+        }
+
+    private:
+        const Test& test;
+        const NeighbourLists& neighbours;
+        TTour tour;
+        int64_t weight;
+        std::mt19937 gen;
+        BestTourTracker best;
+        // every chain polls its own copy, Deadline::Expired() is not thread-safe
+        Deadline deadline;
+        int64_t accepted = 0;
+    };
+
+    /*
+        Replica exchange annealing. Every chain runs at its own step of a geometric temperature
+        ladder scaled by the mean edge of the start tour. Epochs run on a thread pool; between them
+        neighbouring steps (even and odd pairs in turn) swap temperatures with probability
+        min(1, exp((E_i - E_j)(1 / T_i - 1 / T_j))). The result is the best tour of all chains.
+     */
+    class ParallelTempering : public IOptimizer {
+    public:
+        explicit ParallelTempering(int version, OptimizerConfig config, ParallelTemperingOpt opt = {})
+            : IOptimizer(version, std::move(config))
+            , opt(std::move(opt))
+            , gen(0)
+        {}
+
+        Tour optimize(const Test& test, Tour baseline) override {
+            if (PreferTwoLevelList(test.GetVertexNum())) {
+                return run<TwoLevelListTour>(test, std::move(baseline));
+            }
+            return run<ArrayTour>(test, std::move(baseline));
+        }
+
+        std::string optimizer_name() const override  {
+            return "ParallelTempering";
+        }
+
+    private:
+        template <class TTour>
+        Tour run(const Test& test, Tour baseline) {
+            Deadline deadline = start_deadline();
+            baseline.CalcTotalWeight();
+            int n = test.GetVertexNum();
+            if (n < 8) {
+                return baseline;
+            }
+
+            int threads = std::max(1, config.thread_count);
+            int replicas = opt.replicas > 0 ? opt.replicas : std::max(2, threads);
+            double mean_edge = std::max(1.0, (double)baseline.TotalWeight() / n);
+            std::vector<double> temperature(replicas);
+            for (int i = 0; i < replicas; i++) {
+                double t = replicas == 1 ? 0 : (double)i / (replicas - 1);
+                temperature[i] = mean_edge * opt.t_min * std::pow(opt.t_max / opt.t_min, t);
+            }
+
+            NeighbourLists neighbours(test, opt.neighbour_count);
+            std::vector<std::unique_ptr<TemperingChain<TTour>>> chains;
+            // chain_at[i] is the chain currently running at temperature[i]
+            std::vector<int> chain_at(replicas);
+            for (int k = 0; k < replicas; k++) {
+                chains.push_back(std::make_unique<TemperingChain<TTour>>(
+                    test, neighbours, baseline.path, baseline.TotalWeight(), k + 1, deadline
+                ));
+                chain_at[k] = k;
+            }
+
+            ThreadPool pool(threads);
+            ConvergenceRecorder conv(config.save_method_convergence, baseline.convergence);
+            std::uniform_real_distribution<double> unit(0, 1);
+            int64_t rounds = 0;
+            int64_t exchanges = 0;
+            int64_t accepted_exchanges = 0;
+            while (!deadline.Expired()) {
+                std::vector<std::future<void>> results;
+                for (int i = 0; i < replicas; i++) {
+                    results.push_back(pool.enqueue([&, i]() {
+                        chains[chain_at[i]]->Run(temperature[i], opt.epoch);
+                    }));
+                }
+                for (auto& result : results) {
+                    result.get();
+                }
+
+                for (int i = rounds % 2; i + 1 < replicas; i += 2) {
+                    double e_i = chains[chain_at[i]]->Weight();
+                    double e_j = chains[chain_at[i + 1]]->Weight();
+                    double log_prob = (e_i - e_j) * (1 / temperature[i] - 1 / temperature[i + 1]);
+                    exchanges++;
+                    if (log_prob >= 0 || unit(gen) < std::exp(log_prob)) {
+                        std::swap(chain_at[i], chain_at[i + 1]);
+                        accepted_exchanges++;
+                    }
+                }
+                rounds++;
+
+                const auto& leader = best_chain(chains)->Best();
+                publish(leader.BestWeight(), deadline.Passed(), [&]() { return leader.BestPath(); });
+                conv.Record(rounds * opt.epoch, best_chain(chains)->Best().BestWeight());
+            }
+
+            const auto& best = best_chain(chains)->Best();
+            baseline.SetPath(best.BestPath(), best.BestWeight());
+            baseline.convergence = conv.Points();
+            int64_t accepted = 0;
+            for (const auto& chain : chains) {
+                accepted += chain->Accepted();
+            }
+            baseline.statistics["REPLICAS"] = replicas;
+            baseline.statistics["ROUNDS"] = rounds;
+            baseline.statistics["ACCEPTED_MOVES"] = accepted;
+            baseline.statistics["EXCHANGES"] = exchanges;
+            baseline.statistics["ACCEPTED_EXCHANGES"] = accepted_exchanges;
+            baseline.statistics["T_MIN"] = temperature.front();
+            baseline.statistics["T_MAX"] = temperature.back();
+            baseline.statistics["ELAPSED_MS"] = deadline.Passed();
+            return baseline;
+        }
+
+        template <class TChain>
+        static const TChain* best_chain(const std::vector<std::unique_ptr<TChain>>& chains) {
+            const TChain* best = chains.front().get();
+            for (const auto& chain : chains) {
+                if (chain->Best().BestWeight() < best->Best().BestWeight()) {
+                    best = chain.get();
+                }
+            }
+            return best;
+        }
+
+        ParallelTemperingOpt opt;
+        std::mt19937 gen;
+    };
+}
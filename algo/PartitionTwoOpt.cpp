@@ -0,0 +1 @@
+#include "PartitionTwoOpt.h"
@@ -0,0 +1,241 @@
+#pragma once
+
+#include <algo/ConvergenceRecorder.h>
+#include <algo/IOptimizer.h>
+#include <algo/NeighbourLists.h>
+#include <algo/NeighbourhoodSearch.h>
+#include <algo/TwoLevelListTour.h>
+#include <lib/ThreadPool.h>
+#include <lib/Deadline.h>
+
+#include <algorithm>
+#include <climits>
+#include <functional>
+#include <future>
+#include <utility>
+#include <vector>
+
+namespace NAlgo {
+    struct PartitionTwoOptOpt {
+        int neighbour_count = 10;
+        /* reversals inside a segment cost up to its length, longer sub-paths are split further */
+        int max_segment = 5000;
+        /* more segments than threads keep the pool busy when segments converge at different speeds */
+        int segments_per_thread = 2;
+        int min_segment = 8;
+    };
+
+    /*
+        Parallel 2-opt over a partition of the tour. The tour is cut into segments with fixed ends,
+        so moves inside different segments never conflict, and the segments are optimized on a
+        thread pool. After each round the cuts shift by half a segment. After two idle rounds the
+        segments double; past max_segment the tour is finished by a single-threaded 2-opt, since
+        long reversals do not fit in a segment.
+     */
+    class PartitionTwoOpt : public IOptimizer {
+    public:
+        explicit PartitionTwoOpt(int version, OptimizerConfig config, PartitionTwoOptOpt opt = {})
+            : IOptimizer(version, std::move(config))
+            , opt(std::move(opt))
+        {}
+
+        Tour optimize(const Test& test, Tour baseline) override {
+            Deadline deadline = start_deadline();
+            baseline.CalcTotalWeight();
+            int n = test.GetVertexNum();
+            int threads = std::max(1, config.thread_count);
+            if (n < 2 * opt.min_segment) {
+                return baseline;
+            }
+
+            NeighbourLists neighbours(test, opt.neighbour_count);
+            std::vector<int> path = baseline.path;
+            std::vector<int> pos(n);
+            std::vector<int> owner(n);
+            // polled from the segment threads at once
+            auto in_time = [&]() {
+                return !deadline.ExpiredNow();
+            };
+
+            int min_count = std::max(1, (n + opt.max_segment - 1) / opt.max_segment);
+            int count = std::max(min_count, std::min(threads * opt.segments_per_thread, n / opt.min_segment));
+
+            ThreadPool pool(threads);
+            ConvergenceRecorder conv(config.save_method_convergence, baseline.convergence);
+            int64_t weight = baseline.TotalWeight();
+            int64_t rounds = 0;
+            int64_t moves = 0;
+            int idle_rounds = 0;
+            bool converged = false;
+            while (in_time()) {
+                // segments are [k * n / count, (k + 1) * n / count) of the rotated path
+                std::rotate(path.begin(), path.begin() + n / count / 2, path.end());
+                for (int k = 0; k < count; k++) {
+                    for (int i = begin_of(k, n, count); i < begin_of(k + 1, n, count); i++) {
+                        pos[path[i]] = i;
+                        owner[path[i]] = k;
+                    }
+                }
+
+                std::vector<std::future<std::pair<int64_t, int64_t>>> results;
+                for (int k = 0; k < count; k++) {
+                    results.push_back(pool.enqueue([&, k]() {
+                        return optimize_segment(test, neighbours, path, pos, owner, k,
+                                                begin_of(k, n, count), begin_of(k + 1, n, count), in_time);
+                    }));
+                }
+
+                int64_t round_gain = 0;
+                for (auto& result : results) {
+                    auto [gain, segment_moves] = result.get();
+                    round_gain += gain;
+                    moves += segment_moves;
+                }
+                weight -= round_gain;
+                rounds++;
+                publish(weight, deadline.Passed(), [&]() { return path; });
+                conv.Record(rounds, weight);
+
+                idle_rounds = round_gain > 0 ? 0 : idle_rounds + 1;
+                if (idle_rounds == 2) {
+                    if (count == min_count) {
+                        converged = true;
+                        break;
+                    }
+                    count = std::max(min_count, count / 2);
+                    idle_rounds = 0;
+                }
+            }
+
+            bool local_optimum = false;
+            if (converged) {
+                if (PreferTwoLevelList(n)) {
+                    weight += polish<TwoLevelListTour>(test, neighbours, path, moves, local_optimum, in_time);
+                } else {
+                    weight += polish<ArrayTour>(test, neighbours, path, moves, local_optimum, in_time);
+                }
+                publish(weight, deadline.Passed(), [&]() { return path; });
+                conv.Record(rounds + 1, weight);
+            }
+
+            baseline.SetPath(std::move(path), weight);
+            baseline.convergence = conv.Points();
+            baseline.statistics["TWO_OPT_MOVES"] = moves;
+            baseline.statistics["LOCAL_OPTIMUM"] = local_optimum;
+            baseline.statistics["ROUNDS"] = rounds;
+            baseline.statistics["SEGMENTS"] = count;
+            baseline.statistics["THREADS"] = threads;
+            baseline.statistics["ELAPSED_MS"] = deadline.Passed();
+            return baseline;
+        }
+
+        std::string optimizer_name() const override  {
+            return "PartitionTwoOpt";
+        }
+
+    private:
+        static int begin_of(int k, int n, int count) {
+            return (int64_t)k * n / count;
+        }
+
+        template <class TTour>
+        static int64_t polish(const Test& test, const NeighbourLists& neighbours, std::vector<int>& path,
+                              int64_t& moves, bool& local_optimum, const std::function<bool()>& in_time) {
+            NeighbourhoodSearch<TTour> search(test, neighbours);
+            search.SetMonitor([&](int64_t) {
+                return in_time();
+            });
+            int64_t delta = search.Improve(path, LLONG_MAX);
+            moves += search.Moves().two_opt;
+            local_optimum = search.ReachedLocalOptimum();
+            return delta;
+        }
+
+        /*
+         * 2-opt on path[begin, end) with path[begin] and path[end - 1] fixed. Only the cities of
+         * segment k are read or written, so segments can be optimized concurrently.
+         * Returns the gain and the number of applied moves.
+         */
+        static std::pair<int64_t, int64_t> optimize_segment(
+            const Test& test, const NeighbourLists& neighbours, std::vector<int>& path, std::vector<int>& pos,
+            const std::vector<int>& owner, int k, int begin, int end, const std::function<bool()>& in_time
+        ) {
+            std::vector<int> queue(path.begin() + begin, path.begin() + end);
+            std::vector<char> queued(end - begin, 1);
+            size_t head = 0;
+            int64_t gain = 0;
+            int64_t moves = 0;
+
+            auto push = [&](int v) {
+                if (!queued[pos[v] - begin]) {
+                    queued[pos[v] - begin] = 1;
+                    queue.push_back(v);
+                }
+            };
+            auto reverse = [&](int l, int r) {
+                for (; l < r; l++, r--) {
+                    std::swap(path[l], path[r]);
+                    pos[path[l]] = l;
+                    pos[path[r]] = r;
+                }
+            };
+
+            while (head < queue.size()) {
+                if (head % 64 == 0 && !in_time()) {
+                    break;
+                }
+                int a = queue[head++];
+                queued[pos[a] - begin] = 0;
+
+                bool improved = false;
+                for (int dir = 0; dir < 2 && !improved; dir++) {
+                    // dir 0 replaces (a, next(a)), (c, next(c)); dir 1 replaces (prev(a), a), (prev(c), c)
+                    int i = pos[a];
+                    int i1 = dir == 0 ? i + 1 : i - 1;
+                    if (i1 < begin || i1 >= end) {
+                        continue;
+                    }
+                    int a1 = path[i1];
+                    int64_t removed = test.EvalDistance(a, a1);
+
+                    for (int t = 0; t < neighbours.Size(); t++) {
+                        int c = neighbours.Get(a, t);
+                        int64_t added = test.EvalDistance(a, c);
+                        if (added >= removed) {
+                            break;
+                        }
+                        if (owner[c] != k) {
+                            continue;
+                        }
+                        int j = pos[c];
+                        int j1 = dir == 0 ? j + 1 : j - 1;
+                        if (j1 < begin || j1 >= end || c == a1) {
+                            continue;
+                        }
+                        int c1 = path[j1];
+                        int64_t delta = added + test.EvalDistance(a1, c1) - removed - test.EvalDistance(c, c1);
+                        if (delta >= 0) {
+                            continue;
+                        }
+
+                        if (dir == 0) {
+                            reverse(std::min(i, j) + 1, std::max(i, j));
+                        } else {
+                            reverse(std::min(i, j), std::max(i, j) - 1);
+                        }
+                        gain -= delta;
+                        moves++;
+                        for (int v : {a, a1, c, c1}) {
+                            push(v);
+                        }
+                        improved = true;
+                        break;
+                    }
+                }
+            }
+            return {gain, moves};
+        }
+
+        PartitionTwoOptOpt opt;
+    };
+}
@@ -0,0 +1 @@
+#include "Portfolio.h"
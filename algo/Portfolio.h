@@ -0,0 +1,112 @@
+#pragma once
+
+#include <algo/ConvergenceRecorder.h>
+#include <algo/ISolution.h>
+#include <algo/Incumbent.h>
+#include <algo/OptimizerPipeline.h>
+#include <lib/ThreadPool.h>
+#include <lib/Timer.h>
+
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace NAlgo {
+    struct PortfolioMember {
+        std::string name;
+        std::unique_ptr<ISolution> solution;
+        /* may be empty, then the tour of the solution is the answer of the member */
+        std::unique_ptr<OptimizerPipeline> optimizer;
+    };
+
+    /*
+        Members solve one test at once, each on its own thread with its own deadlines, and share
+        an Incumbent: BranchAndBound prunes by the best weight, and all stop once the target is
+        reached. The result is the best member tour, its index is the PORTFOLIO_WINNER statistic.
+     */
+    class Portfolio : public ISolution {
+    public:
+        Portfolio(int version, SolutionConfig config, std::vector<PortfolioMember> members,
+                  std::shared_ptr<Incumbent> incumbent)
+            : ISolution(version, std::move(config))
+            , members(std::move(members))
+            , incumbent(std::move(incumbent))
+        {}
+
+        Tour solve(const Test& test) override {
+            incumbent->Reset();
+            ThreadPool pool(members.size());
+            std::vector<std::future<std::pair<Tour, double>>> results;
+            for (auto& member : members) {
+                results.push_back(pool.enqueue([this, &test, &member]() {
+                    Timer timer;
+                    member.solution->set_improvement_callback(config.on_improvement);
+                    Tour tour = member.solution->solve(test);
+                    if (member.optimizer) {
+                        double start = timer.Passed();
+                        size_t recorded = tour.convergence.size();
+                        member.optimizer->set_improvement_callback(shifted(start));
+                        tour = member.optimizer->optimize(test, std::move(tour));
+                        ShiftConvergence(tour.convergence, recorded, start);
+                    }
+                    tour.CalcTotalWeight();
+                    return std::make_pair(std::move(tour), timer.Passed());
+                }));
+            }
+
+            std::vector<int64_t> weights;
+            std::vector<double> times;
+            std::unique_ptr<Tour> best;
+            int winner = 0;
+            for (size_t i = 0; i < results.size(); i++) {
+                auto [tour, elapsed] = results[i].get();
+                weights.push_back(tour.TotalWeight());
+                times.push_back(elapsed);
+                if (!best || tour.TotalWeight() < best->TotalWeight()) {
+                    best = std::make_unique<Tour>(std::move(tour));
+                    winner = i;
+                }
+            }
+
+            best->statistics["PORTFOLIO_WINNER"] = winner;
+            best->statistics["PORTFOLIO_TARGET_REACHED"] = incumbent->TargetReached();
+            for (size_t i = 0; i < members.size(); i++) {
+                best->statistics["MEMBER" + std::to_string(i) + "_WEIGHT"] = weights[i];
+                best->statistics["MEMBER" + std::to_string(i) + "_MS"] = times[i];
+            }
+            return std::move(*best);
+        }
+
+        std::string solution_name() const override {
+            return "Portfolio";
+        }
+
+        /* the hyperparameters of the members, separated by ';' as the members in the spec */
+        std::string hyperparameters() const override {
+            std::string result;
+            for (size_t i = 0; i < members.size(); i++) {
+                result += (i == 0 ? "" : ";") + members[i].solution->hyperparameters();
+            }
+            return result;
+        }
+
+        const std::string& MemberName(int i) const {
+            return members[i].name;
+        }
+
+    private:
+        /* the callback of the portfolio with the times of an optimizer that started at start */
+        ImprovementCallback shifted(double start) const {
+            if (!config.on_improvement) {
+                return nullptr;
+            }
+            return [callback = config.on_improvement, start](const Improvement& improvement) {
+                callback({improvement.weight, improvement.elapsed_ms + start, improvement.path});
+            };
+        }
+
+        std::vector<PortfolioMember> members;
+        std::shared_ptr<Incumbent> incumbent;
+    };
+}
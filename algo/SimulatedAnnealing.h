@@ -1,97 +1,212 @@
 #pragma once
 
+#include <algo/ArrayTour.h>
+#include <algo/BestTourTracker.h>
+#include <algo/ConvergenceRecorder.h>
 #include <algo/IOptimizer.h>
-#include <lib/Timer.h>
+#include <algo/NeighbourLists.h>
+#include <algo/TwoLevelListTour.h>
+#include <lib/Deadline.h>
+#include <util/Random.h>
 
-#include <iostream>
 #include <cmath>
-#include <random>
+#include <vector>
 
 namespace NAlgo {
+    struct SimulatedAnnealingOpt {
+        /* probability to accept a mean worsening move of the start tour at the start */
+        double initial_acceptance = 0.3;
+        /* T at the deadline relative to T0 */
+        double final_share = 1e-2;
+        int calibration_samples = 1000;
+        /* with no new best for reheat_after of the deadline T goes back up to reheat_share of T0 */
+        double reheat_after = 0.1;
+        double reheat_share = 0.2;
+        int neighbour_count = 8;
+    };
+
+    /*
+        exp(-x) tabulated on [0, MAX_X) with step 1 / 256 and zero beyond: a move worse than 16 T
+        is accepted with probability below 1e-7 anyway.
+     */
+    class ExpTable {
+    public:
+        ExpTable()
+            : table(MAX_X * SCALE)
+        {
+            for (int i = 0; i < (int)table.size(); i++) {
+                table[i] = std::exp(-(i + 0.5) / SCALE);
+            }
+        }
+
+        static constexpr double MAX_X = 16;
+
+        /* x >= 0 */
+        double operator()(double x) const {
+            return x < MAX_X ? table[(int)(x * SCALE)] : 0;
+        }
+
+    private:
+        static constexpr int SCALE = 256;
+
+        std::vector<double> table;
+    };
+
+    /*
+        Annealing over 2-opt moves: a is random and c is random from its neighbour list, so the
+        move joins close cities. It breaks (a, Next(a)), (c, Next(c)) or (Prev(a), a), (Prev(c), c).
+        Moves that do not worsen the tour are accepted without a random draw.
+
+        The temperature follows the elapsed share of the deadline: T0 and the final temperature come
+        from the mean worsening of random moves on the start tour, and T falls geometrically between
+        them. If the best tour stalls, T is raised and cools again towards the deadline.
+     */
     class SimulatedAnnealing : public IOptimizer {
     public:
-        explicit SimulatedAnnealing(int version, OptimizerConfig config)
+        explicit SimulatedAnnealing(int version, OptimizerConfig config, SimulatedAnnealingOpt opt = {})
             : IOptimizer(version, std::move(config))
+            , opt(std::move(opt))
             , gen(0)
         {}
 
         Tour optimize(const Test& test, Tour baseline) override {
-            double T = 100;
-            double alpha = 0.9999;
-
             baseline.CalcTotalWeight();
-            Tour best_tour = baseline;
-            Timer timer;
-
-            int64_t currentWeight = baseline.TotalWeight();
-
-            int iter = 0;
-            std::vector<std::pair<int, int>> conv = baseline.convergence;
-            if (test.GetVertexNum() < 7500) {
-                while (timer.Passed() < config.deadline) {
-                    for (int l = 0; l < test.GetVertexNum(); l++)
-                        for (int r = l + 1; r < test.GetVertexNum(); r++) {
-                            make_iteration(l, r, test, T, baseline, best_tour, currentWeight);
-
-                            if (config.save_method_convergence) {
-                                conv.emplace_back(iter, best_tour.TotalWeight());
-                            }
-                            iter++;
-                        }
-                    T *= alpha;
-                }
-            } else {
-                while (timer.Passed() < config.deadline) {
-                    int l = gen() % (int)test.GetVertexNum();
-                    int r = gen() % (int)test.GetVertexNum();
-
-                    if (l > r)
-                        std::swap(l, r);
-
-                    make_iteration(l ,r, test, T, baseline, best_tour, currentWeight);
-
-                    T *= alpha;
-
-                    if (config.save_method_convergence) {
-                        conv.emplace_back(iter, best_tour.TotalWeight());
-                    }
-                    iter++;
-                }
+            if (test.GetVertexNum() < 8) {
+                return baseline;
             }
-
-            best_tour.convergence = conv;
-            return best_tour;
+            if (PreferTwoLevelList(test.GetVertexNum())) {
+                return anneal<TwoLevelListTour>(test, std::move(baseline));
+            }
+            return anneal<ArrayTour>(test, std::move(baseline));
         }
 
         std::string optimizer_name() const override  {
             return "SimulatedAnnealing";
         }
+
     private:
-        std::mt19937 gen;
+        template <class TTour>
+        Tour anneal(const Test& test, Tour baseline) {
+            Deadline deadline = start_deadline();
+            int n = test.GetVertexNum();
+            NeighbourLists neighbours(test, opt.neighbour_count);
+            int k = neighbours.Size();
+            // d(a, c) of every candidate, the other three lengths depend on the tour
+            std::vector<int64_t> candidate_length((size_t)n * k);
+            for (int a = 0; a < n; a++) {
+                for (int i = 0; i < k; i++) {
+                    candidate_length[(size_t)a * k + i] = test.EvalDistance(a, neighbours.Get(a, i));
+                }
+            }
 
-        double get_random_double() {
-            return 1. * gen() / UINT32_MAX;
-        }
+            TTour tour(baseline.path);
+            int64_t weight = baseline.TotalWeight();
+            BestTourTracker best([&tour]() -> std::vector<int> { return tour.Path(); }, weight, n);
+            ConvergenceRecorder conv(config.save_method_convergence, baseline.convergence);
+
+            double mean_delta = mean_worsening(test, neighbours, tour, candidate_length);
+            double T0 = -mean_delta / std::log(opt.initial_acceptance);
+            double T_end = opt.final_share * T0;
+            // the current cooling stage goes from stage_T at stage_start to T_end at the deadline
+            double stage_start = 0;
+            double stage_T = T0;
+            double last_best_time = 0;
+            int64_t last_best = best.BestWeight();
+            int64_t reheats = 0;
+
+            double T = T0;
+            double inv_T = 1 / T;
+            int64_t proposals = 0;
+            int64_t accepted = 0;
+            while (!deadline.Expired()) {
+                double passed = deadline.Passed();
+                if (best.BestWeight() < last_best) {
+                    last_best = best.BestWeight();
+                    last_best_time = passed;
+                } else if (passed - last_best_time > opt.reheat_after * config.deadline
+                           && config.deadline - passed > opt.reheat_after * config.deadline) {
+                    stage_start = passed;
+                    stage_T = std::max(T, opt.reheat_share * T0);
+                    last_best_time = passed;
+                    reheats++;
+                }
+                double progress = (passed - stage_start) / (config.deadline - stage_start);
+                T = stage_T * std::pow(T_end / stage_T, progress);
+                inv_T = 1 / T;
+
+                for (int iter = 0; iter < BATCH; iter++) {
+                    int a = gen.Below(n);
+                    int i = gen.Below(k);
+                    int c = neighbours.Get(a, i);
+                    bool forward = gen() >> 63;
+                    int b = forward ? tour.Next(a) : tour.Prev(a);
+                    int d = forward ? tour.Next(c) : tour.Prev(c);
+                    if (c == b || d == a) {
+                        continue;
+                    }
 
-        void make_iteration(int l ,int r, const Test &test, double T, Tour& baseline, Tour& best_tour, long long& currentWeight) {
-            int prev = (l - 1 + test.GetVertexNum()) % test.GetVertexNum();
-            int next = (r + 1) % test.GetVertexNum();
-            std::vector<int> &p = baseline.path;
-            double delta_h = test.EvalDistance(p[prev], p[r]) + test.EvalDistance(p[l], p[next]) -
-                             (test.EvalDistance(p[prev], p[l]) + test.EvalDistance(p[r], p[next]));
-            double prob = exp(-delta_h / T);
-            if (delta_h < 0 || get_random_double() < prob) {
-                currentWeight -= test.EvalDistance(p[prev], p[l]) + test.EvalDistance(p[r], p[next]);
-                std::reverse(p.begin() + l, p.begin() + r + 1);
-                currentWeight += test.EvalDistance(p[prev], p[l]) + test.EvalDistance(p[r], p[next]);
+                    int64_t delta = candidate_length[(size_t)a * k + i] + test.EvalDistance(b, d)
+                        - test.EvalDistance(a, b) - test.EvalDistance(c, d);
+                    if (delta <= 0 || gen.NextDouble() < exp_table(delta * inv_T)) {
+                        if (forward) {
+                            tour.Reverse(b, c);
+                        } else {
+                            tour.Reverse(a, d);
+                        }
+                        weight += delta;
+                        best.Record({a, b, c, d}, weight);
+                        accepted++;
+                    }
+                }
+                proposals += BATCH;
+                publish(best.BestWeight(), passed, [&]() { return best.BestPath(); });
+                conv.Record(proposals, best.BestWeight());
             }
 
-            if (currentWeight < best_tour.TotalWeight()) {
-                best_tour = baseline;
-                best_tour.CalcTotalWeight();
-            }
+            double elapsed = deadline.Passed();
+            baseline.SetPath(best.BestPath(), best.BestWeight());
+            baseline.convergence = conv.Points();
+            baseline.statistics["BEST_MATERIALIZATIONS"] = best.Materializations();
+            baseline.statistics["PROPOSALS"] = proposals;
+            baseline.statistics["PROPOSALS_PER_SEC"] = proposals / std::max(elapsed, 1.0) * 1000;
+            baseline.statistics["ACCEPTANCE_RATE"] = proposals ? (double)accepted / proposals : 0;
+            baseline.statistics["T0"] = T0;
+            baseline.statistics["FINAL_T"] = T;
+            baseline.statistics["REHEATS"] = reheats;
+            baseline.statistics["ELAPSED_MS"] = elapsed;
+            return baseline;
+        }
 
+        /* mean positive delta of random proposals on the start tour, nothing is applied */
+        template <class TTour>
+        double mean_worsening(const Test& test, const NeighbourLists& neighbours, const TTour& tour,
+                              const std::vector<int64_t>& candidate_length) {
+            int k = neighbours.Size();
+            double sum = 0;
+            int count = 0;
+            for (int s = 0; s < opt.calibration_samples; s++) {
+                int a = gen.Below(tour.Size());
+                int i = gen.Below(k);
+                int c = neighbours.Get(a, i);
+                int b = tour.Next(a);
+                int d = tour.Next(c);
+                if (c == b || d == a) {
+                    continue;
+                }
+                int64_t delta = candidate_length[(size_t)a * k + i] + test.EvalDistance(b, d)
+                    - test.EvalDistance(a, b) - test.EvalDistance(c, d);
+                if (delta > 0) {
+                    sum += delta;
+                    count++;
+                }
+            }
+            return count > 0 ? std::max(1.0, sum / count) : 1.0;
         }
 
+        static constexpr int BATCH = 1024;
+
+        SimulatedAnnealingOpt opt;
+        NUtil::Xoshiro256 gen;
+        ExpTable exp_table;
     };
 }
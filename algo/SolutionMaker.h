@@ -7,9 +7,19 @@
 #include <algo/BranchAndBound.h>
 #include <algo/GeneticAlgorithm.h>
 #include <algo/SimulatedAnnealing.h>
+#include <algo/LinKernighan.h>
+#include <algo/PartitionTwoOpt.h>
+#include <algo/ParallelTempering.h>
+#include <algo/OptimizerPipeline.h>
+#include <algo/Portfolio.h>
+#include <algo/WarmStart.h>
 
 #include <config/CacheConfig.h>
+#include <util/String.h>
+#include <algorithm>
+#include <cmath>
 #include <fstream>
+#include <stdexcept>
 
 
 namespace NAlgo {
@@ -40,8 +50,98 @@ namespace NAlgo {
         } else if (optimizer_name == "SimulatedAnnealing" or optimizer_name == "SA") {
             optimizer_name = "SimulatedAnnealing";
             return EOptimizer::SimulatedAnnealing;
+        } else if (optimizer_name == "NeighbourTwoOpt" or optimizer_name == "N2OPT") {
+            optimizer_name = "NeighbourTwoOpt";
+            return EOptimizer::NeighbourTwoOpt;
+        } else if (optimizer_name == "OrOpt" or optimizer_name == "OROPT") {
+            optimizer_name = "OrOpt";
+            return EOptimizer::OrOpt;
+        } else if (optimizer_name == "LinKernighan" or optimizer_name == "LK") {
+            optimizer_name = "LinKernighan";
+            return EOptimizer::LinKernighan;
+        } else if (optimizer_name == "PartitionTwoOpt" or optimizer_name == "P2OPT") {
+            optimizer_name = "PartitionTwoOpt";
+            return EOptimizer::PartitionTwoOpt;
+        } else if (optimizer_name == "VectorLocalSearch" or optimizer_name == "VLS") {
+            optimizer_name = "VectorLocalSearch";
+            return EOptimizer::VectorLocalSearch;
+        } else if (optimizer_name == "ParallelTempering" or optimizer_name == "PT") {
+            optimizer_name = "ParallelTempering";
+            return EOptimizer::ParallelTempering;
         }
-        throw;
+        throw std::invalid_argument("Invalid optimizer name: " + optimizer_name);
+    }
+
+    /*
+     * format: <key>=<value>,<key>=<value>,... over the defaults of GAHyperOpt, e.g.
+     * islands=4,memetic=1,crossover=eax,parent=inbreeding,duplicates=replace
+     */
+    GAHyperOpt ParseGAHyperOpt(const std::string& spec) {
+        GAHyperOpt opt;
+        for (const auto& option : NUtil::SplitAndTrim(spec, ',')) {
+            auto tokens = NUtil::SplitAndTrim(option, '=');
+            if (tokens.size() != 2) {
+                throw std::invalid_argument("Invalid GA option: " + option);
+            }
+            const std::string& key = tokens[0];
+            const std::string& value = tokens[1];
+            auto pick = [&](const std::vector<std::string>& names) {
+                auto it = std::find(names.begin(), names.end(), value);
+                if (it == names.end()) {
+                    throw std::invalid_argument("Invalid value of GA option " + key + ": " + value);
+                }
+                return (int)(it - names.begin());
+            };
+            auto number = [&]() {
+                size_t parsed = 0;
+                double result = 0;
+                try {
+                    result = std::stod(value, &parsed);
+                } catch (const std::logic_error&) {
+                }
+                if (parsed == 0 || parsed != value.size()) {
+                    throw std::invalid_argument("Invalid value of GA option " + key + ": " + value);
+                }
+                return result;
+            };
+
+            if (key == "population") {
+                opt.population_size = (int)number();
+            } else if (key == "select") {
+                opt.select_type = (ESelectType)pick({"tournament", "roulette", "ranking"});
+            } else if (key == "parent") {
+                opt.parent_select_type = (EParentSelectType)pick({"inbreeding", "outbreeding", "nothing"});
+            } else if (key == "parent-candidates") {
+                opt.parent_candidates = (int)number();
+            } else if (key == "duplicates") {
+                opt.duplicate_policy = (EDuplicatePolicy)pick({"keep", "reject", "replace"});
+            } else if (key == "crossover") {
+                opt.crossover_type = (ECrossoverType)pick({"uniform", "ox", "pmx", "erx", "eax"});
+            } else if (key == "crossover-rate") {
+                opt.proportion_of_crossover = number();
+            } else if (key == "mutation-rate") {
+                opt.proportion_of_mutation = number();
+            } else if (key == "islands") {
+                opt.island_count = (int)number();
+            } else if (key == "topology") {
+                opt.migration_topology = (EMigrationTopology)pick({"ring", "random"});
+            } else if (key == "migration-interval") {
+                opt.migration_interval = (int)number();
+            } else if (key == "migrants") {
+                opt.migrant_count = (int)number();
+            } else if (key == "seed") {
+                opt.seed = (unsigned)number();
+            } else if (key == "memetic") {
+                opt.memetic = pick({"0", "1"});
+            } else if (key == "improvement-budget") {
+                opt.improvement_budget = (int64_t)number();
+            } else if (key == "neighbours") {
+                opt.neighbour_count = (int)number();
+            } else {
+                throw std::invalid_argument("Unknown GA option: " + key);
+            }
+        }
+        return opt;
     }
 
     int GetSolutionVersion(const std::string& solution_name) {
@@ -63,10 +163,8 @@ namespace NAlgo {
         return version;
     }
 
-    std::unique_ptr<ISolution> MakeSolution(std::string& solution_name, SolutionConfig config) {
-        ESolution solution_code = ParseSolutionName(solution_name);
-        int version = GetSolutionVersion(solution_name);
-
+    std::unique_ptr<ISolution> MakeSolution(ESolution solution_code, int version, SolutionConfig config,
+                                            const GAHyperOpt& ga_opt = {}) {
         switch (solution_code) {
             case ESolution::NearestNeighbour:
                 return std::make_unique<NearestNeighbour>(version, std::move(config));
@@ -77,7 +175,7 @@ namespace NAlgo {
             case ESolution::BranchAndBound:
                 return std::make_unique<BranchAndBound>(version, std::move(config));
             case ESolution::GeneticAlgorithm:
-                return std::make_unique<GeneticAlgorithm>(version, std::move(config));
+                return std::make_unique<GeneticAlgorithm>(version, std::move(config), ga_opt);
             case ESolution::INVALID_SOLUTION_NAME:
                 throw std::runtime_error("Invalid solution name");
             default:
@@ -85,17 +183,150 @@ namespace NAlgo {
         }
     }
 
-    std::unique_ptr<IOptimizer> MakeOptimizer(std::string& optimizer_name, OptimizerConfig config) {
-        EOptimizer optimizer_code = ParseOptimizerName(optimizer_name);
-        int version = GetSolutionVersion(optimizer_name);
+    std::unique_ptr<ISolution> MakeSolution(std::string& solution_name, SolutionConfig config, const GAHyperOpt& ga_opt = {}) {
+        ESolution solution_code = ParseSolutionName(solution_name);
+        int version = GetSolutionVersion(solution_name);
+        return MakeSolution(solution_code, version, std::move(config), ga_opt);
+    }
 
+    std::unique_ptr<IOptimizer> MakeOptimizer(EOptimizer optimizer_code, int version, OptimizerConfig config) {
         switch (optimizer_code) {
             case EOptimizer::LocalSearch:
                 return std::make_unique<LocalSearch>(version, std::move(config));
             case EOptimizer::SimulatedAnnealing:
                 return std::make_unique<SimulatedAnnealing>(version, std::move(config));
+            case EOptimizer::NeighbourTwoOpt:
+                return std::make_unique<LocalSearch>(
+                    version, std::move(config), LocalSearchOpt{.mode = ELocalSearchMode::NeighbourLists}
+                );
+            case EOptimizer::OrOpt:
+                return std::make_unique<LocalSearch>(
+                    version, std::move(config), LocalSearchOpt{.mode = ELocalSearchMode::NeighbourLists, .or_opt = true}
+                );
+            case EOptimizer::LinKernighan:
+                return std::make_unique<LinKernighan>(version, std::move(config));
+            case EOptimizer::PartitionTwoOpt:
+                return std::make_unique<PartitionTwoOpt>(version, std::move(config));
+            case EOptimizer::VectorLocalSearch:
+                return std::make_unique<LocalSearch>(
+                    version, std::move(config), LocalSearchOpt{.mode = ELocalSearchMode::VectorSweep}
+                );
+            case EOptimizer::ParallelTempering:
+                return std::make_unique<ParallelTempering>(version, std::move(config));
             default:
                 return nullptr;
         }
     }
+
+    std::unique_ptr<IOptimizer> MakeOptimizer(std::string& optimizer_name, OptimizerConfig config) {
+        EOptimizer optimizer_code = ParseOptimizerName(optimizer_name);
+        int version = GetSolutionVersion(optimizer_name);
+        return MakeOptimizer(optimizer_code, version, std::move(config));
+    }
+
+    struct PipelineStageSpec {
+        EOptimizer optimizer;
+        double budget;
+    };
+
+    /*
+     * format: <name>[:<budget>],<name>[:<budget>],...
+     * budget is in milliseconds if > 1 and a share of the deadline otherwise, stages without
+     * a budget share the rest equally. Short names are replaced by full ones.
+     */
+    std::vector<PipelineStageSpec> ParsePipelineSpec(std::string& pipeline_spec) {
+        std::vector<PipelineStageSpec> stages;
+        std::string canonical;
+        for (const auto& stage_spec : NUtil::SplitAndTrim(pipeline_spec, ',')) {
+            auto tokens = NUtil::SplitAndTrim(stage_spec, ':');
+            // empty parts are dropped by the split, so the colons are counted separately
+            size_t colons = std::count(stage_spec.begin(), stage_spec.end(), ':');
+            if (tokens.empty() || tokens.size() > 2 || tokens.size() != colons + 1) {
+                throw std::runtime_error("Invalid optimizer stage: " + stage_spec);
+            }
+            std::string name = tokens[0];
+            EOptimizer optimizer_code = ParseOptimizerName(name);
+            double budget = 0;
+            if (tokens.size() == 2) {
+                size_t parsed = 0;
+                try {
+                    budget = std::stod(tokens[1], &parsed);
+                } catch (const std::logic_error&) {
+                    parsed = 0;
+                }
+                if (parsed == 0 || parsed != tokens[1].size() || !(budget > 0) || !std::isfinite(budget)) {
+                    throw std::runtime_error("Invalid optimizer stage: " + stage_spec);
+                }
+            }
+
+            canonical += (canonical.empty() ? "" : ",") + name + (tokens.size() == 2 ? ":" + tokens[1] : "");
+            stages.push_back({optimizer_code, budget});
+        }
+        if (stages.empty()) {
+            throw std::runtime_error("Empty optimizer pipeline");
+        }
+
+        pipeline_spec = canonical;
+        return stages;
+    }
+
+    std::unique_ptr<OptimizerPipeline> MakePipeline(const std::vector<PipelineStageSpec>& stage_specs, int version,
+                                                    OptimizerConfig config) {
+        std::vector<PipelineStage> stages;
+        for (const auto& stage_spec : stage_specs) {
+            stages.push_back({MakeOptimizer(stage_spec.optimizer, 0, config), stage_spec.budget});
+        }
+        return std::make_unique<OptimizerPipeline>(version, std::move(config), std::move(stages));
+    }
+
+    std::unique_ptr<OptimizerPipeline> MakePipeline(std::string& pipeline_spec, int version, OptimizerConfig config) {
+        return MakePipeline(ParsePipelineSpec(pipeline_spec), version, std::move(config));
+    }
+
+    /* the version is counted for the whole chain */
+    std::unique_ptr<OptimizerPipeline> MakePipeline(std::string& pipeline_spec, OptimizerConfig config) {
+        // the spec is validated and gets its full names before the version is counted
+        auto stage_specs = ParsePipelineSpec(pipeline_spec);
+        return MakePipeline(stage_specs, GetSolutionVersion(pipeline_spec), std::move(config));
+    }
+
+    /*
+     * format: <solution>[+<optimizer pipeline>];<solution>[+<optimizer pipeline>];...
+     * every member solves with solution_config and optimizes with optimizer_config, the members
+     * stop when one of them finds a tour not longer than target. Names are replaced by full ones.
+     */
+    std::unique_ptr<Portfolio> MakePortfolio(std::string& portfolio_spec, int version, SolutionConfig solution_config,
+                                             OptimizerConfig optimizer_config, int64_t target = 0,
+                                             const GAHyperOpt& ga_opt = {}) {
+        auto cancel = std::make_shared<CancelToken>();
+        auto incumbent = std::make_shared<Incumbent>(target, cancel);
+        solution_config.cancel = optimizer_config.cancel = cancel;
+        solution_config.incumbent = optimizer_config.incumbent = incumbent;
+
+        std::vector<PortfolioMember> members;
+        std::string canonical;
+        for (const auto& member_spec : NUtil::SplitAndTrim(portfolio_spec, ';')) {
+            auto tokens = NUtil::SplitAndTrim(member_spec, '+');
+            if (tokens.empty() || tokens.size() > 2) {
+                throw std::runtime_error("Invalid portfolio member: " + member_spec);
+            }
+            PortfolioMember member;
+            std::string solution_name = tokens[0];
+            member.solution = MakeSolution(ParseSolutionName(solution_name), 0, solution_config, ga_opt);
+            member.name = solution_name;
+            if (tokens.size() == 2) {
+                std::string pipeline_spec = tokens[1];
+                member.optimizer = MakePipeline(pipeline_spec, 0, optimizer_config);
+                member.name += "+" + pipeline_spec;
+            }
+            canonical += (canonical.empty() ? "" : ";") + member.name;
+            members.push_back(std::move(member));
+        }
+        if (members.empty()) {
+            throw std::runtime_error("Empty portfolio");
+        }
+
+        portfolio_spec = canonical;
+        return std::make_unique<Portfolio>(version, std::move(solution_config), std::move(members), std::move(incumbent));
+    }
 }
@@ -4,6 +4,7 @@
 #include <util/String.h>
 #include <util/Ensure.h>
 
+#include <algorithm>
 #include <iostream>
 #include <fstream>
 #include <filesystem>
@@ -12,16 +13,18 @@ namespace NAlgo {
     Test::Test(const std::filesystem::path &dataset_location, const std::string &test_name) {
         auto full_path = dataset_location / (test_name + ".tsp");
 
-        name = test_name;
+        auto parsed = std::make_shared<Data>();
+        parsed->name = test_name;
         std::ifstream test_in(full_path);
         if (test_in) {
-            ParseTestFromFile(test_in);
+            ParseTestFromFile(test_in, *parsed);
+            data = std::move(parsed);
         } else {
             throw std::runtime_error("failed load test " + test_name);
         }
     }
 
-    void Test::ParseTestFromFile(std::istream &test_in) {
+    void Test::ParseTestFromFile(std::istream &test_in, Data& data) {
         std::string line;
         while (true) {
             getline(test_in, line);
@@ -36,23 +39,23 @@ namespace NAlgo {
 
             if (tokens[0] == "NAME") {
                 NUtil::Ensure(
-                    tokens[1] == name || tokens[1] == name + ".tsp",
+                    tokens[1] == data.name || tokens[1] == data.name + ".tsp",
                     "test_name in file doesn't match file name"
                 );
             } else if (tokens[0] == "COMMENT") {
-                comment = tokens[1];
+                data.comment = tokens[1];
             } else if (tokens[0] == "DIMENSION") {
-                vertex_num = atoi(tokens[1].c_str());
+                data.vertex_num = atoi(tokens[1].c_str());
             } else if (tokens[0] == "TYPE") {
                 NUtil::Ensure(
                         tokens[1] == "TSP",
                         "invalid test: not for this type of task"
                 );
             } else if (tokens[0] == "EDGE_WEIGHT_TYPE") {
-                distance_function = MakeDistanceFunction(tokens[1]);
-                weight_type = tokens[1];
+                data.distance_function = MakeDistanceFunction(tokens[1]);
+                data.weight_type = tokens[1];
             } else if(tokens[0] == "EDGE_WEIGHT_FORMAT") {
-                weight_format = tokens[1];
+                data.weight_format = tokens[1];
             } else if (tokens[0] == "DISPLAY_DATA_TYPE") {
                 // todo check tokens[1]
             } else if (tokens[0] == "NODE_COORD_TYPE") {
@@ -62,50 +65,50 @@ namespace NAlgo {
             }
         }
 
-        if (weight_type == "EUC_2D" || weight_type == "ATT" || weight_type == "CEIL_2D" || weight_type  == "GEO") {
-            points.resize(vertex_num);
-            for (int i = 0; i < vertex_num; i++) {
+        if (data.weight_type == "EUC_2D" || data.weight_type == "ATT" || data.weight_type == "CEIL_2D" || data.weight_type  == "GEO") {
+            data.points.resize(data.vertex_num);
+            for (int i = 0; i < data.vertex_num; i++) {
                 double vertex, x, y;
                 if (!(test_in >> vertex >> x >> y)) {
                     throw std::runtime_error("unexpected end of file");
                 }
-                points[--vertex] = {x, y};
+                data.points[--vertex] = {x, y};
             }
-        } else if  (weight_type == "EXPLICIT") {
-            if (weight_format == "FULL_MATRIX") {
-                for (int i = 0; i < vertex_num; i++) {
+        } else if  (data.weight_type == "EXPLICIT") {
+            if (data.weight_format == "FULL_MATRIX") {
+                for (int i = 0; i < data.vertex_num; i++) {
                     std::vector<int> l;
-                    for (int j = 0; j < vertex_num; j++) {
+                    for (int j = 0; j < data.vertex_num; j++) {
                         int w;
                         if (!(test_in >> w)) {
                             throw std::runtime_error("unexpected end of file");
                         }
                         l.push_back(w);
                     }
-                    matrix.push_back(l);
+                    data.matrix.push_back(l);
                 }
-            } else if (weight_format == "UPPER_ROW") {
-                matrix.assign(vertex_num, std::vector<int>(vertex_num, 0));
-                for (int i = 0; i < vertex_num; i++) {
-                    for (int j = i + 1; j < vertex_num; j++) {
-                        test_in >> matrix[i][j];
-                        matrix[j][i] = matrix[i][j];
+            } else if (data.weight_format == "UPPER_ROW") {
+                data.matrix.assign(data.vertex_num, std::vector<int>(data.vertex_num, 0));
+                for (int i = 0; i < data.vertex_num; i++) {
+                    for (int j = i + 1; j < data.vertex_num; j++) {
+                        test_in >> data.matrix[i][j];
+                        data.matrix[j][i] = data.matrix[i][j];
                     }
                 }
-            } else if (weight_format == "LOWER_DIAG_ROW") {
-                matrix.assign(vertex_num, std::vector<int>(vertex_num, 0));
-                for (int i = 0; i < vertex_num; i++) {
+            } else if (data.weight_format == "LOWER_DIAG_ROW") {
+                data.matrix.assign(data.vertex_num, std::vector<int>(data.vertex_num, 0));
+                for (int i = 0; i < data.vertex_num; i++) {
                     for (int j = 0; j <= i; j++) {
-                        test_in >> matrix[i][j];
-                        matrix[j][i] = matrix[i][j];
+                        test_in >> data.matrix[i][j];
+                        data.matrix[j][i] = data.matrix[i][j];
                     }
                 }
-            } else if (weight_format == "UPPER_DIAG_ROW") {
-                matrix.assign(vertex_num, std::vector<int>(vertex_num, 0));
-                for (int i = 0; i < vertex_num; i++) {
-                    for (int j = i; j < vertex_num; j++) {
-                        test_in >> matrix[i][j];
-                        matrix[j][i] = matrix[i][j];
+            } else if (data.weight_format == "UPPER_DIAG_ROW") {
+                data.matrix.assign(data.vertex_num, std::vector<int>(data.vertex_num, 0));
+                for (int i = 0; i < data.vertex_num; i++) {
+                    for (int j = i; j < data.vertex_num; j++) {
+                        test_in >> data.matrix[i][j];
+                        data.matrix[j][i] = data.matrix[i][j];
                     }
                 }
             }
@@ -132,8 +135,10 @@ namespace NAlgo {
                 all_tests.push_back(Test(dataset_location, NUtil::Split(p.path().filename().string(), '.')[0]));
             }
         }
-
-
+        // directory order is unspecified, results of "all" runs are listed by name
+        std::sort(all_tests.begin(), all_tests.end(), [](const Test& a, const Test& b) {
+            return a.GetTestName() < b.GetTestName();
+        });
         return all_tests;
     }
 }
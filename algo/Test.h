@@ -2,6 +2,9 @@
 
 #include <string>
 #include <filesystem>
+#include <functional>
+#include <memory>
+#include <stdexcept>
 #include <vector>
 
 namespace NAlgo {
@@ -9,61 +12,77 @@ namespace NAlgo {
         long double x, y;
     };
 
+    /*
+        A loaded test never changes, so its data is shared: copying a Test (and a Tour or a
+        TestResult) copies a pointer, not the points or the n x n matrix.
+     */
     class Test {
     public:
         explicit Test(const std::filesystem::path& dataset_location, const std::string& test_name);
 
         Point GetPoint(int index) const {
-            if (points.empty()) {
+            if (data->points.empty()) {
                 throw std::runtime_error("no points where given for the test");
             }
-            return points.at(index);
+            return data->points.at(index);
         }
 
-        std::vector<Point> GetPoints() const {
-            return points;
+        const std::vector<Point>& GetPoints() const {
+            return data->points;
+        }
+
+        bool HasPoints() const {
+            return !data->points.empty();
         }
 
         int GetVertexNum() const {
-            return vertex_num;
+            return data->vertex_num;
         }
 
         int GetMatrixValue(int u, int v) const {
-            return matrix[u][v];
+            return data->matrix[u][v];
         };
 
         int64_t EvalDistance(int u, int v) const {
-            return distance_function(*this, u, v);
+            return data->distance_function(*this, u, v);
+        }
+
+        const std::string& GetTestName() const {
+            return data->name;
         }
 
-        std::string GetTestName() const {
-            return name;
+        const std::string& GetWeightType() const {
+            return data->weight_type;
         }
 
     private:
-        void ParseTestFromFile(std::istream& test_in);
-
-        std::string name;
-        std::string comment;
-        int vertex_num;
-
-        std::function<int64_t(const Test&, int, int)> distance_function;
-        std::string weight_type;
-        std::string weight_format;
-
-        /*
-         * EDGE_WEIGHT_TYPE:
-         *   EUC_2D test
-         *   ATT test
-         *   CEIL_2D test
-         */
-        std::vector<Point> points;
-
-        /*
-         * EDGE_WEIGHT_TYPE:
-         *   EXPLICIT test
-         */
-        std::vector<std::vector<int>> matrix;
+        struct Data {
+            std::string name;
+            std::string comment;
+            int vertex_num = 0;
+
+            std::function<int64_t(const Test&, int, int)> distance_function;
+            std::string weight_type;
+            std::string weight_format;
+
+            /*
+             * EDGE_WEIGHT_TYPE:
+             *   EUC_2D test
+             *   ATT test
+             *   CEIL_2D test
+             */
+            std::vector<Point> points;
+
+            /*
+             * EDGE_WEIGHT_TYPE:
+             *   EXPLICIT test
+             */
+            std::vector<std::vector<int>> matrix;
+        };
+
+        static void ParseTestFromFile(std::istream& test_in, Data& data);
+
+        std::shared_ptr<const Data> data;
     };
 
     Test LoadSingleTest(const std::filesystem::path& dataset_location, const std::string& test_name);
@@ -2,7 +2,27 @@
 
 #include <algo/Test.h>
 
+#include <algorithm>
+#include <map>
+#include <stdexcept>
+
 namespace NAlgo {
+    struct ConvergencePoint {
+        ConvergencePoint(int64_t iter, int64_t weight, double duplicate_rate = -1, double elapsed_ms = 0)
+            : iter(iter)
+            , weight(weight)
+            , duplicate_rate(duplicate_rate)
+            , elapsed_ms(elapsed_ms)
+        {}
+
+        int64_t iter;
+        int64_t weight;
+        // share of duplicate individuals in the generation, -1 if not tracked
+        double duplicate_rate;
+        // since the start of the method that recorded the point
+        double elapsed_ms;
+    };
+
     class Tour {
     public:
         Tour(Test test)
@@ -11,32 +31,171 @@ namespace NAlgo {
         {
         }
 
-        int64_t TotalWeight() {
+        int64_t TotalWeight() const {
             return total_weight;
         }
 
         void CalcTotalWeight()  {
+            total_weight = PathWeight(test, path);
+        }
+
+        static int64_t PathWeight(const Test& test, const std::vector<int>& path) {
             if (path.empty()) {
-                total_weight = LONG_LONG_MAX;
+                return LONG_LONG_MAX;
+            }
+            int64_t weight = 0;
+            for (size_t i = 0; i < path.size(); i++) {
+                weight += test.EvalDistance(path[i], path[(i + 1) % path.size()]);
+            }
+            return weight;
+        }
+
+        /* Replaces the path with one whose weight the caller already knows. */
+        void SetPath(std::vector<int> new_path, int64_t weight) {
+            path = std::move(new_path);
+            total_weight = weight;
+            validate();
+        }
+
+        /*
+            Moves by positions in path, which wrap around. *Delta returns the weight change in O(1),
+            Apply* applies the move, updates total_weight and returns the same change.
+         */
+
+        /* reverses path[l..r], going forward from l to r */
+        int64_t TwoOptDelta(int l, int r) const {
+            int n = path.size();
+            int prev = path[(l - 1 + n) % n], next = path[(r + 1) % n];
+            if ((r + 1) % n == l) {
+                return 0;
+            }
+            return test.EvalDistance(prev, path[r]) + test.EvalDistance(path[l], next)
+                - test.EvalDistance(prev, path[l]) - test.EvalDistance(path[r], next);
+        }
+
+        /* the complementary range gives the same cycle, so the shorter one is reversed */
+        int64_t ApplyTwoOpt(int l, int r) {
+            int64_t delta = TwoOptDelta(l, r);
+            int n = path.size();
+            int len = (r - l + n) % n + 1;
+            if (2 * len > n) {
+                int new_l = (r + 1) % n;
+                r = (l - 1 + n) % n;
+                l = new_l;
+                len = n - len;
+            }
+            for (int k = 0; k < len / 2; k++) {
+                std::swap(path[(l + k) % n], path[(r - k + n) % n]);
+            }
+            total_weight += delta;
+            validate();
+            return delta;
+        }
+
+        /*
+         * moves the segment path[from .. from + len - 1] between path[to] and the city after it,
+         * reversed if asked; to must lie outside of [from - 1, from + len - 1]
+         */
+        int64_t OrOptDelta(int from, int len, int to, bool reversed) const {
+            int n = path.size();
+            int p = path[(from - 1 + n) % n], s1 = path[from], s2 = path[(from + len - 1) % n];
+            int next = path[(from + len) % n];
+            int u = path[to], w = path[(to + 1) % n];
+            int64_t removed = test.EvalDistance(p, s1) + test.EvalDistance(s2, next) - test.EvalDistance(p, next);
+            int64_t inserted = reversed
+                ? test.EvalDistance(u, s2) + test.EvalDistance(s1, w)
+                : test.EvalDistance(u, s1) + test.EvalDistance(s2, w);
+            return inserted - test.EvalDistance(u, w) - removed;
+        }
+
+        int64_t ApplyOrOpt(int from, int len, int to, bool reversed) {
+            int64_t delta = OrOptDelta(from, len, to, reversed);
+            int n = path.size();
+            int gap_after = (to - (from + len - 1) + n) % n; // cities between the segment and to, inclusive
+            int gap_before = n - len - gap_after;
+            std::vector<int> range;
+            if (gap_after <= gap_before) {
+                // [segment][next .. to] -> [next .. to][segment]
+                for (int k = 0; k < len + gap_after; k++) {
+                    range.push_back(path[(from + k) % n]);
+                }
+                std::rotate(range.begin(), range.begin() + len, range.end());
+                if (reversed) {
+                    std::reverse(range.end() - len, range.end());
+                }
+                for (int k = 0; k < (int)range.size(); k++) {
+                    path[(from + k) % n] = range[k];
+                }
             } else {
-                total_weight = 0;
-                for (size_t i = 0; i < path.size(); i++) {
-                    total_weight += test.EvalDistance(path[i], path[(i + 1) % path.size()]);
+                // [w .. p][segment] -> [segment][w .. p]
+                int start = (to + 1) % n;
+                for (int k = 0; k < gap_before + len; k++) {
+                    range.push_back(path[(start + k) % n]);
+                }
+                std::rotate(range.begin(), range.end() - len, range.end());
+                if (reversed) {
+                    std::reverse(range.begin(), range.begin() + len);
+                }
+                for (int k = 0; k < (int)range.size(); k++) {
+                    path[(start + k) % n] = range[k];
+                }
+            }
+            total_weight += delta;
+            validate();
+            return delta;
+        }
+
+        /* swaps the cities at positions i and j */
+        int64_t SwapDelta(int i, int j) const {
+            int n = path.size();
+            if (i == j) {
+                return 0;
+            }
+            auto at = [&](int k) {
+                return k == i ? path[j] : k == j ? path[i] : path[k];
+            };
+            // edges are identified by their first position; neighbouring swaps share one
+            int edges[4] = {(i - 1 + n) % n, i, (j - 1 + n) % n, j};
+            int64_t delta = 0;
+            for (int e = 0; e < 4; e++) {
+                if (std::find(edges, edges + e, edges[e]) != edges + e) {
+                    continue;
                 }
+                int k = edges[e], k1 = (k + 1) % n;
+                delta += test.EvalDistance(at(k), at(k1)) - test.EvalDistance(path[k], path[k1]);
             }
+            return delta;
         }
 
-        std::string GetTestName()  {
+        int64_t ApplySwap(int i, int j) {
+            int64_t delta = SwapDelta(i, j);
+            std::swap(path[i], path[j]);
+            total_weight += delta;
+            validate();
+            return delta;
+        }
+
+        const std::string& GetTestName() const {
             return test.GetTestName();
         }
 
-        Test GetTest() {
+        const Test& GetTest() const {
             return test;
         }
 
         std::vector<int> path;
-        std::vector<std::pair<int, int>> convergence;
+        std::vector<ConvergencePoint> convergence;
+        std::map<std::string, double> statistics;
     private:
+        /* with TSP_VALIDATE_TOUR every incremental update is checked against a full recomputation */
+        void validate() const {
+#ifdef TSP_VALIDATE_TOUR
+            if (PathWeight(test, path) != total_weight) {
+                throw std::runtime_error("Incremental tour weight differs from the recomputed one");
+            }
+#endif
+        }
+
         int64_t total_weight;
         Test test;
     };
@@ -0,0 +1,116 @@
+#include "TourFile.h"
+
+#include <util/String.h>
+#include <util/Ensure.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <vector>
+
+namespace NAlgo {
+    Tour ReadTour(const Test& test, const std::filesystem::path& path) {
+        std::ifstream tour_in(path);
+        if (!tour_in) {
+            throw std::runtime_error("failed load tour " + path.string());
+        }
+
+        std::string line;
+        while (true) {
+            NUtil::Ensure(static_cast<bool>(getline(tour_in, line)), "tour doesn't contain TOUR_SECTION");
+            line = NUtil::Trim(line);
+            if (line == "TOUR_SECTION") {
+                break;
+            }
+
+            auto tokens = NUtil::SplitAndTrim(line, ':');
+            if (tokens.size() < 2) {
+                continue;
+            }
+            if (tokens[0] == "TYPE") {
+                NUtil::Ensure(tokens[1] == "TOUR", "invalid tour: not a tour file");
+            } else if (tokens[0] == "DIMENSION") {
+                NUtil::Ensure(
+                    atoi(tokens[1].c_str()) == test.GetVertexNum(),
+                    "tour dimension doesn't match test " + test.GetTestName()
+                );
+            }
+        }
+
+        int n = test.GetVertexNum();
+        std::vector<int> path_read;
+        int vertex;
+        while (tour_in >> vertex && vertex != -1) {
+            path_read.push_back(vertex);
+        }
+        NUtil::Ensure((int)path_read.size() == n, "tour doesn't visit every city of test " + test.GetTestName());
+
+        // a permutation of 1..n contains n, a permutation of 0..n-1 does not
+        int base = *std::max_element(path_read.begin(), path_read.end()) == n ? 1 : 0;
+        std::vector<char> visited(n, false);
+        for (auto& v : path_read) {
+            v -= base;
+            NUtil::Ensure(0 <= v && v < n && !visited[v], "tour isn't a permutation of the cities");
+            visited[v] = true;
+        }
+
+        Tour tour(test);
+        tour.path = std::move(path_read);
+        tour.CalcTotalWeight();
+        return tour;
+    }
+
+    /* the WEIGHT of a tour file of a test with vertex_num cities, nullopt if the header has none */
+    static std::optional<int64_t> read_weight(const std::filesystem::path& path, int vertex_num) {
+        std::ifstream tour_in(path);
+        std::optional<int64_t> weight;
+        bool dimension_matches = false;
+        std::string line;
+        while (getline(tour_in, line)) {
+            line = NUtil::Trim(line);
+            if (line == "TOUR_SECTION") {
+                break;
+            }
+            auto tokens = NUtil::SplitAndTrim(line, ':');
+            if (tokens.size() < 2) {
+                continue;
+            }
+            if (tokens[0] == "WEIGHT") {
+                weight = atoll(tokens[1].c_str());
+            } else if (tokens[0] == "DIMENSION") {
+                dimension_matches = atoi(tokens[1].c_str()) == vertex_num;
+            }
+        }
+        if (!dimension_matches) {
+            return std::nullopt;
+        }
+        return weight;
+    }
+
+    std::optional<TourFile> FindBestTour(const Test& test, const std::filesystem::path& directory) {
+        if (!std::filesystem::exists(directory)) {
+            return std::nullopt;
+        }
+        std::vector<std::pair<int64_t, std::filesystem::path>> candidates;
+        std::string prefix = test.GetTestName() + "_";
+        for (auto& p : std::filesystem::directory_iterator(directory)) {
+            std::string file_name = p.path().filename().string();
+            if (file_name.rfind(prefix, 0) != 0 || p.path().extension() != ".tour") {
+                continue;
+            }
+            if (auto weight = read_weight(p.path(), test.GetVertexNum())) {
+                candidates.emplace_back(weight.value(), p.path());
+            }
+        }
+        std::sort(candidates.begin(), candidates.end());
+
+        // the header may belong to an unfinished or a foreign file, then the next one is tried
+        for (const auto& [weight, path] : candidates) {
+            try {
+                return TourFile{path, ReadTour(test, path)};
+            } catch (const std::runtime_error&) {
+            }
+        }
+        return std::nullopt;
+    }
+}
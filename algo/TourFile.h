@@ -0,0 +1,26 @@
+#pragma once
+
+#include <algo/Tour.h>
+
+#include <filesystem>
+#include <optional>
+
+namespace NAlgo {
+    struct TourFile {
+        std::filesystem::path path;
+        Tour tour;
+    };
+
+    /*
+        Reads a TSPLIB tour: "KEY : VALUE" lines up to TOUR_SECTION, then cities up to -1. Cities
+        count from 1 as in *.opt.tour or from 0 as in the runner's tours, whichever the tour fits.
+        Other header fields are skipped and the weight is recomputed.
+     */
+    Tour ReadTour(const Test& test, const std::filesystem::path& path);
+
+    /*
+        The lightest of the <test>_*.tour files in directory by their WEIGHT headers, nullopt if none
+        of them is a tour of the test. Only the chosen file is read in full.
+     */
+    std::optional<TourFile> FindBestTour(const Test& test, const std::filesystem::path& directory);
+}
@@ -0,0 +1 @@
+#include "TwoLevelListTour.h"
@@ -0,0 +1,220 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace NAlgo {
+    /*
+        Two-level doubly linked list: ~sqrt(n) segments, each an array of cities with a reversal bit.
+        Next/Prev/Between are O(1). Reverse is O(sqrt(n)): it splits segments at the ends of the path
+        and reverses the order of whole segments (or of the complement), flipping their bits.
+        Same semantics as ArrayTour.
+     */
+    class TwoLevelListTour {
+    public:
+        explicit TwoLevelListTour(const std::vector<int>& path) {
+            build(path);
+        }
+
+        int Size() const {
+            return seg.size();
+        }
+
+        int Next(int v) const {
+            int s = seg[v];
+            int i = idx[v];
+            const std::vector<int>& a = items[s];
+            if (!reversed[s]) {
+                if (i + 1 < (int)a.size()) {
+                    return a[i + 1];
+                }
+            } else if (i > 0) {
+                return a[i - 1];
+            }
+            return first(order[rank[s] + 1 == (int)order.size() ? 0 : rank[s] + 1]);
+        }
+
+        int Prev(int v) const {
+            int s = seg[v];
+            int i = idx[v];
+            const std::vector<int>& a = items[s];
+            if (!reversed[s]) {
+                if (i > 0) {
+                    return a[i - 1];
+                }
+            } else if (i + 1 < (int)a.size()) {
+                return a[i + 1];
+            }
+            return last(order[rank[s] == 0 ? order.size() - 1 : rank[s] - 1]);
+        }
+
+        /* b lies on the path a -> ... -> c */
+        bool Between(int a, int b, int c) const {
+            int64_t ka = key(a), kb = key(b), kc = key(c);
+            if (ka <= kc) {
+                return ka <= kb && kb <= kc;
+            }
+            return kb >= ka || kb <= kc;
+        }
+
+        void Reverse(int from, int to) {
+            if (from == to || Next(to) == from) {
+                return;
+            }
+
+            if (seg[from] == seg[to]) {
+                if (oriented(from) <= oriented(to)) {
+                    reverse_inside(from, to);
+                } else {
+                    // the path wraps around the tour, its complement lies inside the segment
+                    reverse_inside(Next(to), Prev(from));
+                }
+                return;
+            }
+
+            if (oriented(from) > 0) {
+                split(seg[from], oriented(from));
+            }
+            if (oriented(to) + 1 < (int)items[seg[to]].size()) {
+                split(seg[to], oriented(to) + 1);
+            }
+
+            int count = order.size();
+            int l = rank[seg[from]];
+            int r = rank[seg[to]];
+            int len = (r - l + count) % count + 1;
+            if (2 * len > count) {
+                int new_l = (r + 1) % count;
+                r = (l - 1 + count) % count;
+                l = new_l;
+                len = count - len;
+            }
+
+            for (int k = 0; k < len; k++) {
+                reversed[order[(l + k) % count]] ^= 1;
+            }
+            for (int k = 0; k < len / 2; k++) {
+                std::swap(order[l], order[r]);
+                rank[order[l]] = l;
+                rank[order[r]] = r;
+                l = l + 1 == count ? 0 : l + 1;
+                r = r == 0 ? count - 1 : r - 1;
+            }
+
+            if ((int)order.size() > max_segments) {
+                build(Path());
+            }
+        }
+
+        std::vector<int> Path() const {
+            std::vector<int> path;
+            path.reserve(seg.size());
+            for (int s : order) {
+                if (reversed[s]) {
+                    path.insert(path.end(), items[s].rbegin(), items[s].rend());
+                } else {
+                    path.insert(path.end(), items[s].begin(), items[s].end());
+                }
+            }
+            return path;
+        }
+
+    private:
+        void build(const std::vector<int>& path) {
+            int n = path.size();
+            int size = std::max(8, (int)std::sqrt((double)n));
+            int count = (n + size - 1) / size;
+
+            items.assign(count, {});
+            reversed.assign(count, 0);
+            order.resize(count);
+            rank.resize(count);
+            seg.resize(n);
+            idx.resize(n);
+            for (int s = 0; s < count; s++) {
+                order[s] = rank[s] = s;
+                items[s].assign(path.begin() + s * size, path.begin() + std::min(n, (s + 1) * size));
+                renumber(s, 0);
+            }
+            max_segments = 2 * count + 2;
+        }
+
+        int first(int s) const {
+            return reversed[s] ? items[s].back() : items[s].front();
+        }
+
+        int last(int s) const {
+            return reversed[s] ? items[s].front() : items[s].back();
+        }
+
+        /* position of v inside its segment in the direction of Next */
+        int oriented(int v) const {
+            return reversed[seg[v]] ? items[seg[v]].size() - 1 - idx[v] : idx[v];
+        }
+
+        int64_t key(int v) const {
+            return (int64_t)rank[seg[v]] * seg.size() + oriented(v);
+        }
+
+        void renumber(int s, int from) {
+            for (int i = from; i < (int)items[s].size(); i++) {
+                seg[items[s][i]] = s;
+                idx[items[s][i]] = i;
+            }
+        }
+
+        void reverse_inside(int from, int to) {
+            int s = seg[from];
+            int l = std::min(idx[from], idx[to]);
+            int r = std::max(idx[from], idx[to]);
+            std::reverse(items[s].begin() + l, items[s].begin() + r + 1);
+            for (int i = l; i <= r; i++) {
+                idx[items[s][i]] = i;
+            }
+        }
+
+        /* keeps the first k cities (in the direction of Next) in s and moves the rest into a new segment after it */
+        void split(int s, int k) {
+            int t = items.size();
+            std::vector<int>& a = items[s];
+            int len = a.size();
+            std::vector<int> tail;
+            if (!reversed[s]) {
+                tail.assign(a.begin() + k, a.end());
+                a.resize(k);
+            } else {
+                tail.assign(a.begin(), a.begin() + (len - k));
+                a.erase(a.begin(), a.begin() + (len - k));
+                renumber(s, 0);
+            }
+
+            items.push_back(std::move(tail));
+            reversed.push_back(reversed[s]);
+            renumber(t, 0);
+
+            rank.push_back(0);
+            order.insert(order.begin() + rank[s] + 1, t);
+            for (int r = rank[s] + 1; r < (int)order.size(); r++) {
+                rank[order[r]] = r;
+            }
+        }
+
+        std::vector<std::vector<int>> items;
+        std::vector<char> reversed;
+        std::vector<int> order;
+        std::vector<int> rank;
+        std::vector<int> seg;
+        std::vector<int> idx;
+        int max_segments = 0;
+    };
+
+    /*
+     * Array reversals cost up to n / 2, list reversals ~sqrt(n) with a larger constant in Next/Prev.
+     * Lin-Kernighan from a scattered start is ~2.5x faster on the list for rl11849 and ~3.5x for d18512.
+     */
+    inline bool PreferTwoLevelList(int vertex_num) {
+        return vertex_num >= 8000;
+    }
+}
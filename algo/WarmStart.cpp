@@ -0,0 +1 @@
+#include "WarmStart.h"
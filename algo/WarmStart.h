@@ -0,0 +1,53 @@
+#pragma once
+
+#include <algo/ISolution.h>
+#include <algo/TourFile.h>
+#include <config/CacheConfig.h>
+
+#include <filesystem>
+#include <functional>
+#include <optional>
+
+namespace NAlgo {
+    /* the best known tour of a test, nullopt if there is none */
+    using BestTourFinder = std::function<std::optional<Tour>(const Test&)>;
+
+    /*
+        Returns a ready tour instead of building one: from the given file, or the best saved
+        result of the test without one. The optimizer goes on from where the last run stopped.
+        find_best looks the result up, the lightest tour file in results/ by default.
+     */
+    class WarmStart : public ISolution {
+    public:
+        explicit WarmStart(int version, SolutionConfig config, std::optional<std::filesystem::path> source = std::nullopt,
+                           BestTourFinder find_best = nullptr)
+            : ISolution(version, std::move(config))
+            , source(std::move(source))
+            , find_best(std::move(find_best))
+        {}
+
+        Tour solve(const Test& test) override {
+            if (source) {
+                return ReadTour(test, source.value());
+            }
+            std::optional<Tour> best;
+            if (find_best) {
+                best = find_best(test);
+            } else if (auto file = FindBestTour(test, NConfig::CacheConfig::CACHE_DIRECTORY)) {
+                best = std::move(file->tour);
+            }
+            if (!best) {
+                throw std::runtime_error("no saved tours of test " + test.GetTestName() + " to start from");
+            }
+            return std::move(best.value());
+        }
+
+        std::string solution_name() const override  {
+            return "WarmStart";
+        }
+
+    private:
+        std::optional<std::filesystem::path> source;
+        BestTourFinder find_best;
+    };
+}
@@ -3,4 +3,6 @@
 namespace NConfig {
     const std::filesystem::path CacheConfig::CACHE_DIRECTORY = "./results";
     const std::filesystem::path CacheConfig::CONVERGENCE_DIRECTORY = "./convergence";
+    const std::filesystem::path CacheConfig::RESULT_CACHE_DIRECTORY = "./results/cache";
+    const int CacheConfig::ALGORITHMS_REVISION = 1;
 }
@@ -7,5 +7,8 @@ namespace NConfig {
     public:
         static const std::filesystem::path CACHE_DIRECTORY;
         static const std::filesystem::path CONVERGENCE_DIRECTORY;
+        static const std::filesystem::path RESULT_CACHE_DIRECTORY;
+        /* part of every result cache key, bump it when an algorithm starts returning other tours */
+        static const int ALGORITHMS_REVISION;
     };
 }
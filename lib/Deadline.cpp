@@ -0,0 +1 @@
+#include "Deadline.h"
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+
+/* cancels every algorithm solving one test */
+class CancelToken {
+public:
+    void Cancel() {
+        cancelled.store(true, std::memory_order_relaxed);
+    }
+
+    bool Cancelled() const {
+        return cancelled.load(std::memory_order_relaxed);
+    }
+
+    void Reset() {
+        cancelled.store(false, std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<bool> cancelled{false};
+};
+
+/*
+    A steady_clock deadline with a cancel token. Expired() is cheap enough for inner loops: it reads
+    the clock once per stride calls, and the stride adapts to about CHECK_INTERVAL_US between reads.
+    Once expired, it stays expired. Expired() is not thread-safe, use ExpiredNow() from many threads.
+ */
+class Deadline {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit Deadline(double budget_ms = 0, std::shared_ptr<const CancelToken> cancel = nullptr)
+        : start(Clock::now())
+        , end(start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::milli>(budget_ms)))
+        , last_check(start)
+        , budget_ms(budget_ms)
+        , cancel(std::move(cancel))
+    {}
+
+    bool Expired() {
+        if (--countdown > 0) {
+            return false;
+        }
+        return check();
+    }
+
+    /* reads the clock on every call, safe to call concurrently */
+    bool ExpiredNow() const {
+        return (cancel && cancel->Cancelled()) || Clock::now() >= end;
+    }
+
+    double Passed() const {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    double Budget() const {
+        return budget_ms;
+    }
+
+    /* how late Expired() noticed the deadline, 0 while it has not or if the run was cancelled */
+    double Overrun() const {
+        return overrun_ms;
+    }
+
+private:
+    bool check() {
+        if (expired) {
+            countdown = MAX_STRIDE;
+            return true;
+        }
+        auto now = Clock::now();
+        double since_us = std::chrono::duration<double, std::micro>(now - last_check).count();
+        if (since_us < CHECK_INTERVAL_US / 2) {
+            stride = std::min(stride * 2, MAX_STRIDE);
+        } else if (since_us > CHECK_INTERVAL_US * 2) {
+            stride = std::max(stride / 2, (int64_t)1);
+        }
+        last_check = now;
+        countdown = stride;
+
+        if (cancel && cancel->Cancelled()) {
+            expired = true;
+        } else if (now >= end) {
+            expired = true;
+            overrun_ms = std::chrono::duration<double, std::milli>(now - end).count();
+        }
+        return expired;
+    }
+
+    static constexpr double CHECK_INTERVAL_US = 50;
+    static constexpr int64_t MAX_STRIDE = 1 << 20;
+
+    Clock::time_point start;
+    Clock::time_point end;
+    Clock::time_point last_check;
+    double budget_ms;
+    std::shared_ptr<const CancelToken> cancel;
+    int64_t stride = 1;
+    int64_t countdown = 1;
+    bool expired = false;
+    double overrun_ms = 0;
+};
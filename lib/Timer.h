@@ -4,20 +4,22 @@
 
 class Timer {
 private:
-    std::chrono::time_point<std::chrono::system_clock> start;
+    // steady_clock does not jump when the system time is adjusted
+    std::chrono::time_point<std::chrono::steady_clock> start;
 
 public:
     Timer() {
         Reset();
     }
 
-    double Passed() {
-        const auto delta = std::chrono::system_clock::now() - start;
-        return std::chrono::duration_cast<std::chrono::milliseconds>(delta).count();
+    /* milliseconds with a fractional part */
+    double Passed() const {
+        const auto delta = std::chrono::steady_clock::now() - start;
+        return std::chrono::duration<double, std::milli>(delta).count();
     }
 
     void Reset() {
-        start = std::chrono::system_clock::now();
+        start = std::chrono::steady_clock::now();
     }
 
     double PassedAndReset() {
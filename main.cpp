@@ -1,5 +1,6 @@
 #include <iostream>
 #include <cxxopts.hpp>
+#include <runner/CrossoverBenchmark.h>
 #include <runner/SolutionsRunner.h>
 #include <util/String.h>
 
@@ -14,6 +15,10 @@ using namespace std;
 
 // ./tsp --mode run-solution --solution-name NearestNeighbour --test-name a280
 // ./tsp --mode run-solution --solution-name NearestNeighbour --test-name a280 --optimizer-name LocalSearch
+// ./tsp --mode run-solution --solution-name NearestNeighbour --test-name pr2392 --optimizer-name N2OPT,SA:0.5,N2OPT
+// ./tsp --mode run-solution --portfolio "GA;BAB;NN+N2OPT,SA" --test-name st70 --target-weight 675
+// ./tsp --mode run-solution --solution-name GA --test-name pr2392 --thread-count 4 --ga-options islands=4,memetic=1,crossover=eax
+// ./tsp --mode run-solution --warm-start best --test-name pr2392 --optimizer-name SA
 std::string read_exact_weight(std::string test_name) {
     std::filesystem::path p = "./exact_tour_weights";
     std::ifstream file_in(p);
@@ -109,7 +114,7 @@ int main(int argc, char** argv) {
     opt_parser.allow_unrecognised_options();
 
     opt_parser.add_options("Mode chooser")
-            ("mode", "-- choose launch mode from (run-solution)", ::cxxopts::value<std::string>());
+            ("mode", "-- choose launch mode from (run-solution, list-solutions, list-optimizers, bench-crossover, list-best)", ::cxxopts::value<std::string>());
 
     auto options = opt_parser.parse(argc, argv);
     auto mode = options["mode"].as<std::string>();
@@ -134,7 +139,12 @@ int main(int argc, char** argv) {
             )
             (
                 "thread-count",
-                "-- amount of threads in multithreading mode",
+                "-- amount of threads in multithreading mode, also used by optimizers",
+                ::cxxopts::value<int>()->default_value("1")
+            )
+            (
+                "jobs",
+                "-- amount of tests solved concurrently with --test-name all, each with --thread-count threads",
                 ::cxxopts::value<int>()->default_value("1")
             )
             (
@@ -144,7 +154,7 @@ int main(int argc, char** argv) {
             )
             (
                 "optimizer-name",
-                "-- choose optimizer algorithm",
+                "-- choose optimizer algorithm or a comma-separated chain NAME[:BUDGET], BUDGET in ms or share of the deadline",
                 ::cxxopts::value<std::string>()->default_value("")
             )
             (
@@ -152,6 +162,38 @@ int main(int argc, char** argv) {
                 "-- deadline for optimizer in milliseconds",
                 ::cxxopts::value<double>()->default_value("2000")
             )
+            (
+                "portfolio",
+                "-- solve every test by several algorithms at once and keep the best tour, "
+                "format: SOLUTION[+OPTIMIZERS];SOLUTION[+OPTIMIZERS];..., replaces --solution-name",
+                ::cxxopts::value<std::string>()
+            )
+            (
+                "target-weight",
+                "-- portfolio members stop as soon as one of them finds a tour of at most this weight",
+                ::cxxopts::value<int64_t>()->default_value("0")
+            )
+            (
+                "snapshot-interval",
+                "-- while a test runs its best tour is saved at most once per this many milliseconds, 0 turns it off",
+                ::cxxopts::value<double>()->default_value("1000")
+            )
+            (
+                "warm-start",
+                "-- start the optimizer from this tour file, or from the best saved result of the test if \"best\", "
+                "replaces --solution-name",
+                ::cxxopts::value<std::string>()
+            )
+            (
+                "ga-options",
+                "-- GeneticAlgorithm hyperparameters, format: KEY=VALUE,KEY=VALUE,..., e.g. "
+                "islands=4,memetic=1,crossover=eax,parent=inbreeding,duplicates=replace",
+                ::cxxopts::value<std::string>()->default_value("")
+            )
+            (
+                "no-cache",
+                "-- run deterministic solutions again even if their result is cached"
+            )
             (
                 "comment",
                 "-- write a comment to your solution",
@@ -164,19 +206,33 @@ int main(int argc, char** argv) {
 
         auto run_solution_options = solution_opt_parser.parse(argc, argv);
 
-        auto solution_name = run_solution_options["solution-name"].as<std::string>();
+        std::optional<std::string> portfolio;
+        if (run_solution_options.count("portfolio")) {
+            portfolio = run_solution_options["portfolio"].as<std::string>();
+        }
+        std::optional<std::string> warm_start;
+        if (run_solution_options.count("warm-start")) {
+            warm_start = run_solution_options["warm-start"].as<std::string>();
+        }
+        auto solution_name = portfolio.has_value() ? "Portfolio"
+            : warm_start.has_value() ? "WarmStart"
+            : run_solution_options["solution-name"].as<std::string>();
         auto solution_deadline = run_solution_options["solution-deadline"].as<double>();
         auto thread_count = run_solution_options["thread-count"].as<int>();
         auto test_name = run_solution_options["test-name"].as<std::string>();
+        auto jobs = run_solution_options["jobs"].as<int>();
         auto save_method_convergence = run_solution_options["save-convergence"].count() != 0;
 
         std::optional<std::string> optimizer_name;
         std::optional<NAlgo::OptimizerConfig> optimizer_config;
-        if (run_solution_options.count("optimizer-name")) {
-            optimizer_name = run_solution_options["optimizer-name"].as<std::string>();
+        if (run_solution_options.count("optimizer-name") || portfolio.has_value()) {
+            if (run_solution_options.count("optimizer-name")) {
+                optimizer_name = run_solution_options["optimizer-name"].as<std::string>();
+            }
             optimizer_config = NAlgo::OptimizerConfig();
             optimizer_config->deadline = run_solution_options["optimizer-deadline"].as<double>();
             optimizer_config->save_method_convergence = save_method_convergence;
+            optimizer_config->thread_count = thread_count;
         }
 
         std::optional<std::string> comment;
@@ -195,7 +251,14 @@ int main(int argc, char** argv) {
                 .deadline = solution_deadline,
                 .thread_count = thread_count,
                 .save_method_convergence = save_method_convergence
-            }
+            },
+            jobs,
+            portfolio,
+            run_solution_options["target-weight"].as<int64_t>(),
+            run_solution_options["snapshot-interval"].as<double>(),
+            warm_start,
+            run_solution_options["no-cache"].count() == 0,
+            NAlgo::ParseGAHyperOpt(run_solution_options["ga-options"].as<std::string>())
         );
 
         std::vector<NRunner::TestResult> runResults;
@@ -233,12 +296,46 @@ int main(int argc, char** argv) {
     } else if (mode == "list-optimizers"){
         std::vector<std::string> all_optimizers = {
             "LocalSearch",
-            "SimulatedAnnealing"
+            "SimulatedAnnealing",
+            "NeighbourTwoOpt",
+            "OrOpt",
+            "LinKernighan",
+            "PartitionTwoOpt",
+            "VectorLocalSearch",
+            "ParallelTempering"
         };
 
         std::cout << "Available optimizers: " << std::endl;
         for (auto opt : all_optimizers)
             std::cout << opt << std::endl;
+    } else if (mode == "bench-crossover") {
+        cxxopts::Options bench_opt_parser("", "");
+        bench_opt_parser.allow_unrecognised_options();
+
+        bench_opt_parser.add_options("Benchmark options")
+            (
+                "test-name",
+                "-- choose test to benchmark crossovers on",
+                ::cxxopts::value<std::string>()->default_value("pr2392")
+            )
+            (
+                "solution-deadline",
+                "-- deadline for the genetic algorithm with each crossover in milliseconds",
+                ::cxxopts::value<double>()->default_value("3000")
+            );
+
+        auto bench_options = bench_opt_parser.parse(argc, argv);
+        auto test = NAlgo::LoadSingleTest(
+            NConfig::DatasetConfig::DATASET_LOCATION,
+            bench_options["test-name"].as<std::string>()
+        );
+        NRunner::BenchmarkCrossovers(test, 1000, bench_options["solution-deadline"].as<double>());
+    } else if (mode == "list-best") {
+        NRunner::ResultCache cache(NConfig::CacheConfig::RESULT_CACHE_DIRECTORY, NConfig::DatasetConfig::DATASET_LOCATION);
+        for (const auto& entry : cache.Best()) {
+            std::cout << entry.test_name << " " << entry.weight << " " << entry.config << " "
+                      << cache.TourPath(entry).string() << std::endl;
+        }
     }
     return 0;
 }
@@ -0,0 +1 @@
+#include "AnytimeWriter.h"
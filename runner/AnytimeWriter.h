@@ -0,0 +1,128 @@
+#pragma once
+
+#include <algo/Improvement.h>
+#include <lib/Timer.h>
+
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace NRunner {
+    /*
+        Saves the best tour while the algorithm runs, so a crash or a stop keeps the result. The
+        callback copies the path at most once per interval_ms and only if it beats the saved one;
+        a background thread writes a temporary file and renames it to path.
+     */
+    class AnytimeWriter {
+    public:
+        AnytimeWriter(std::filesystem::path path, std::string name, double interval_ms)
+            : path(std::move(path))
+            , name(std::move(name))
+            , interval_ms(interval_ms)
+            , writer([this]() { run(); })
+        {}
+
+        ~AnytimeWriter() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stopped = true;
+            }
+            condition.notify_one();
+            writer.join();
+        }
+
+        NAlgo::ImprovementCallback Callback() {
+            return [this](const NAlgo::Improvement& improvement) {
+                on_improvement(improvement);
+            };
+        }
+
+    private:
+        void on_improvement(const NAlgo::Improvement& improvement) {
+            if (!improvement.path) {
+                return;
+            }
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (improvement.weight >= snapshot_weight || since_snapshot.Passed() < interval_ms) {
+                    return;
+                }
+                since_snapshot.Reset();
+            }
+
+            // the copy is made outside of the lock, other threads of the algorithm do not wait for it
+            std::vector<int> tour = improvement.path();
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (improvement.weight >= snapshot_weight) {
+                    return;
+                }
+                snapshot_weight = improvement.weight;
+                pending = std::move(tour);
+                pending_ms = since_start.Passed();
+                has_pending = true;
+            }
+            condition.notify_one();
+        }
+
+        void run() {
+            std::unique_lock<std::mutex> lock(mutex);
+            while (true) {
+                condition.wait(lock, [this]() { return stopped || has_pending; });
+                if (!has_pending) {
+                    return;
+                }
+                std::vector<int> tour = std::move(pending);
+                int64_t weight = snapshot_weight;
+                double elapsed = pending_ms;
+                has_pending = false;
+
+                lock.unlock();
+                write(tour, weight, elapsed);
+                lock.lock();
+            }
+        }
+
+        void write(const std::vector<int>& tour, int64_t weight, double elapsed) const {
+            std::filesystem::path temporary = path;
+            temporary += ".tmp";
+            {
+                std::ofstream out(temporary);
+                out << "NAME: " << name << std::endl;
+                out << "TYPE: TOUR" << std::endl;
+                out << "DIMENSION: " << tour.size() << std::endl;
+                out << "WEIGHT: " << weight << std::endl;
+                out << "SNAPSHOT_MS: " << elapsed << std::endl;
+                out << "TOUR_SECTION" << std::endl;
+                for (auto v : tour) {
+                    out << v << std::endl;
+                }
+                out << -1 << std::endl;
+            }
+            std::filesystem::rename(temporary, path);
+        }
+
+        std::filesystem::path path;
+        std::string name;
+        double interval_ms;
+
+        std::mutex mutex;
+        std::condition_variable condition;
+        Timer since_start;
+        Timer since_snapshot;
+        int64_t snapshot_weight = std::numeric_limits<int64_t>::max();
+        std::vector<int> pending;
+        double pending_ms = 0;
+        bool has_pending = false;
+        bool stopped = false;
+
+        // started last, after everything it reads is initialized
+        std::thread writer;
+    };
+}
@@ -0,0 +1 @@
+#include "CrossoverBenchmark.h"
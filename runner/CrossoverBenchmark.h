@@ -0,0 +1,67 @@
+#pragma once
+
+#include <algo/Crossover.h>
+#include <algo/GeneticAlgorithm.h>
+#include <algo/NeighbourLists.h>
+#include <lib/Timer.h>
+
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace NRunner {
+    struct CrossoverBenchmarkResult {
+        std::string crossover_name;
+        double children_per_second;
+        int64_t weight;
+    };
+
+    /*
+     * For every crossover: throughput on random parents for bench_ms milliseconds and the weight
+     * a GeneticAlgorithm with that crossover reaches within deadline_ms.
+     */
+    inline std::vector<CrossoverBenchmarkResult> BenchmarkCrossovers(const NAlgo::Test& test, double bench_ms, double deadline_ms) {
+        const std::vector<std::pair<std::string, NAlgo::ECrossoverType>> crossovers = {
+            {"Uniform", NAlgo::ECrossoverType::Uniform},
+            {"Order", NAlgo::ECrossoverType::Order},
+            {"PartiallyMapped", NAlgo::ECrossoverType::PartiallyMapped},
+            {"EdgeRecombination", NAlgo::ECrossoverType::EdgeRecombination},
+            {"EdgeAssembly", NAlgo::ECrossoverType::EdgeAssembly}
+        };
+
+        NAlgo::NeighbourLists neighbours(test, NAlgo::GAHyperOpt().neighbour_count);
+        NAlgo::Crossover crossover(test, &neighbours);
+        std::mt19937 gen(0);
+
+        std::vector<std::vector<int>> parents(16, std::vector<int>(test.GetVertexNum()));
+        for (auto& parent : parents) {
+            std::iota(parent.begin(), parent.end(), 0);
+            std::shuffle(parent.begin(), parent.end(), gen);
+        }
+
+        std::vector<CrossoverBenchmarkResult> results;
+        for (const auto& [name, type] : crossovers) {
+            Timer timer;
+            int64_t children = 0;
+            while (timer.Passed() < bench_ms) {
+                const auto& first = parents[children % parents.size()];
+                const auto& second = parents[(children + 1) % parents.size()];
+                auto child = crossover.Cross(type, first, second, gen);
+                children += child.size() > 0;
+            }
+            double children_per_second = children / (timer.Passed() / 1000);
+
+            NAlgo::GAHyperOpt hyper_opt;
+            hyper_opt.crossover_type = type;
+            NAlgo::GeneticAlgorithm ga(0, {.deadline = deadline_ms, .thread_count = 1, .save_method_convergence = false}, hyper_opt);
+            auto tour = ga.solve(test);
+
+            results.push_back({name, children_per_second, tour.TotalWeight()});
+            std::cout << name << ": " << children_per_second << " children/s, weight "
+                      << tour.TotalWeight() << " after " << deadline_ms << " ms" << std::endl;
+        }
+        return results;
+    }
+}
@@ -0,0 +1,190 @@
+#pragma once
+
+#include <algo/TourFile.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace NRunner {
+    struct CacheEntry {
+        std::string key;
+        std::string instance;
+        int64_t weight;
+        bool deterministic;
+        std::string test_name;
+        std::string config;
+    };
+
+    /*
+        Content-addressed results. The key hashes the test file with the run config, the tour is in
+        <key>.tour, and only tours of deterministic runs are reused. The index is append-only lines
+        "<key> <instance> <weight> <deterministic> <test> <config>", a later line of a key replaces
+        an earlier one, so the best tour of a test is found without reading tours.
+     */
+    class ResultCache {
+    public:
+        ResultCache(std::filesystem::path directory, std::filesystem::path dataset_location)
+            : directory(std::move(directory))
+            , dataset_location(std::move(dataset_location))
+        {
+            std::filesystem::create_directories(this->directory);
+            std::ifstream in(this->directory / "index");
+            std::string line;
+            while (getline(in, line)) {
+                std::istringstream fields(line);
+                CacheEntry entry;
+                if (fields >> entry.key >> entry.instance >> entry.weight >> entry.deterministic
+                           >> entry.test_name >> entry.config) {
+                    entries[entry.key] = std::move(entry);
+                }
+            }
+        }
+
+        /* the tour of a deterministic run with this config, nullopt if there is none */
+        std::optional<NAlgo::Tour> Find(const NAlgo::Test& test, const std::string& config) {
+            std::string key = make_key(test, config);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                auto it = entries.find(key);
+                if (it == entries.end() || !it->second.deterministic) {
+                    return std::nullopt;
+                }
+            }
+            try {
+                return NAlgo::ReadTour(test, directory / (key + ".tour"));
+            } catch (const std::runtime_error&) {
+                return std::nullopt;
+            }
+        }
+
+        /*
+         * a deterministic tour replaces a non-deterministic one whatever their weights, so that Find
+         * can reuse it, and is never replaced by one; otherwise the lighter tour is kept
+         */
+        void Store(const NAlgo::Tour& tour, const std::string& config, bool deterministic) {
+            CacheEntry entry{
+                make_key(tour.GetTest(), config), instance_hash(tour.GetTest()), tour.TotalWeight(),
+                deterministic, tour.GetTestName(), config
+            };
+
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = entries.find(entry.key);
+            if (it != entries.end() && (it->second.deterministic > deterministic
+                                        || (it->second.deterministic == deterministic && it->second.weight <= entry.weight))) {
+                return;
+            }
+
+            std::filesystem::path path = directory / (entry.key + ".tour");
+            std::filesystem::path temporary = path;
+            temporary += ".tmp";
+            {
+                std::ofstream out(temporary);
+                out << "NAME: " << entry.test_name << std::endl;
+                out << "TYPE: TOUR" << std::endl;
+                out << "DIMENSION: " << tour.path.size() << std::endl;
+                out << "WEIGHT: " << entry.weight << std::endl;
+                out << "CONFIG: " << entry.config << std::endl;
+                out << "TOUR_SECTION" << std::endl;
+                for (auto v : tour.path) {
+                    out << v << std::endl;
+                }
+                out << -1 << std::endl;
+            }
+            std::filesystem::rename(temporary, path);
+
+            std::ofstream index(directory / "index", std::ios::app);
+            index << entry.key << ' ' << entry.instance << ' ' << entry.weight << ' ' << entry.deterministic
+                  << ' ' << entry.test_name << ' ' << entry.config << std::endl;
+            entries[entry.key] = std::move(entry);
+        }
+
+        /* the lightest tour of every test instance in the cache, by test name */
+        std::vector<CacheEntry> Best() const {
+            std::map<std::string, CacheEntry> best;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                for (const auto& [key, entry] : entries) {
+                    auto it = best.find(entry.instance);
+                    if (it == best.end() || entry.weight < it->second.weight) {
+                        best[entry.instance] = entry;
+                    }
+                }
+            }
+            std::vector<CacheEntry> result;
+            for (auto& [instance, entry] : best) {
+                result.push_back(std::move(entry));
+            }
+            std::sort(result.begin(), result.end(), [](const CacheEntry& a, const CacheEntry& b) {
+                return a.test_name < b.test_name;
+            });
+            return result;
+        }
+
+        /* the lightest tour of this test instance in the cache, nullopt if there is none */
+        std::optional<CacheEntry> Best(const NAlgo::Test& test) {
+            std::string instance = instance_hash(test);
+            std::optional<CacheEntry> best;
+            std::lock_guard<std::mutex> lock(mutex);
+            for (const auto& [key, entry] : entries) {
+                if (entry.instance == instance && (!best || entry.weight < best->weight)) {
+                    best = entry;
+                }
+            }
+            return best;
+        }
+
+        std::filesystem::path TourPath(const CacheEntry& entry) const {
+            return directory / (entry.key + ".tour");
+        }
+
+    private:
+        /* FNV-1a, unlike std::hash it is the same on every platform and run */
+        static uint64_t fnv1a(const std::string& data, uint64_t hash = 14695981039346656037ULL) {
+            for (unsigned char c : data) {
+                hash = (hash ^ c) * 1099511628211ULL;
+            }
+            return hash;
+        }
+
+        static std::string hex(uint64_t value) {
+            std::ostringstream out;
+            out << std::hex;
+            out.width(16);
+            out.fill('0');
+            out << value;
+            return out.str();
+        }
+
+        /* a test file is hashed once per cache */
+        std::string instance_hash(const NAlgo::Test& test) {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = instances.find(test.GetTestName());
+            if (it != instances.end()) {
+                return it->second;
+            }
+            std::ifstream in(dataset_location / (test.GetTestName() + ".tsp"), std::ios::binary);
+            std::ostringstream content;
+            content << in.rdbuf();
+            return instances[test.GetTestName()] = hex(fnv1a(content.str()));
+        }
+
+        std::string make_key(const NAlgo::Test& test, const std::string& config) {
+            return hex(fnv1a(instance_hash(test) + " " + config));
+        }
+
+        std::filesystem::path directory;
+        std::filesystem::path dataset_location;
+
+        mutable std::mutex mutex;
+        std::map<std::string, CacheEntry> entries;
+        std::map<std::string, std::string> instances;
+    };
+}
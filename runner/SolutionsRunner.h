@@ -1,10 +1,19 @@
 #pragma once
 
 #include <algo/SolutionMaker.h>
+#include <runner/AnytimeWriter.h>
+#include <runner/ResultCache.h>
 #include <algo/Distance.h>
 #include <config/DatasetConfig.h>
+#include <lib/ThreadPool.h>
 #include <lib/Timer.h>
+#include <util/Ensure.h>
 
+#include <algorithm>
+#include <functional>
+#include <future>
+#include <numeric>
+#include <sstream>
 #include <optional>
 #include <string>
 #include <memory>
@@ -15,11 +24,13 @@
 namespace NRunner {
     struct TestResult {
         NAlgo::Tour tour;
-        std::string solution_name;
-        int solution_version;
-        double run_time_ms;
-        std::string optimizer_name;
-        int optimizer_version;
+        std::string solution_name = {};
+        int solution_version = 0;
+        double run_time_ms = 0;
+        /* empty without an optimizer */
+        std::string optimizer_name = {};
+        int optimizer_version = 0;
+        std::vector<NAlgo::StageReport> stages = {};
     };
 
     class SolutionsRunner {
@@ -30,10 +41,27 @@ namespace NRunner {
             std::optional<std::string> optimizer_name,
             std::optional<NAlgo::OptimizerConfig> optimizer_config,
             std::optional<std::string> comment,
-            NAlgo::SolutionConfig solution_config
+            NAlgo::SolutionConfig _solution_config,
+            int jobs = 1,
+            std::optional<std::string> portfolio = std::nullopt,
+            int64_t target_weight = 0,
+            double snapshot_interval_ms = 0,
+            std::optional<std::string> warm_start = std::nullopt,
+            bool reuse_cached = true,
+            NAlgo::GAHyperOpt ga_opt = {}
         )
-            : test_name(std::move(_test_name))
+            : solution_config(std::move(_solution_config))
+            , optimizer_config(std::move(optimizer_config))
+            , portfolio(std::move(portfolio))
+            , target_weight(target_weight)
+            , snapshot_interval_ms(snapshot_interval_ms)
+            , warm_start(std::move(warm_start))
+            , jobs(jobs)
+            , test_name(std::move(_test_name))
             , comment(std::move(comment))
+            , cache(NConfig::CacheConfig::RESULT_CACHE_DIRECTORY, NConfig::DatasetConfig::DATASET_LOCATION)
+            , reuse_cached(reuse_cached)
+            , ga_opt(std::move(ga_opt))
         {
             if (test_name == "all") {
                 tests = NAlgo::LoadAllTests(NConfig::DatasetConfig::DATASET_LOCATION);
@@ -41,10 +69,55 @@ namespace NRunner {
                 tests = {NAlgo::LoadSingleTest(NConfig::DatasetConfig::DATASET_LOCATION, test_name)};
             }
 
-            solution = NAlgo::MakeSolution(solution_name, solution_config);
+            NUtil::Ensure(
+                !this->portfolio.has_value() || !this->warm_start.has_value(),
+                "a portfolio builds its own tours and can't be warm started"
+            );
+            if (this->portfolio.has_value()) {
+                NUtil::Ensure(
+                    this->optimizer_config.has_value(),
+                    "a portfolio needs an optimizer config for the optimizers of its members"
+                );
+                solution_name = "Portfolio";
+                auto made = NAlgo::MakePortfolio(
+                    this->portfolio.value(), NAlgo::GetSolutionVersion(solution_name), solution_config,
+                    this->optimizer_config.value(), target_weight, this->ga_opt
+                );
+                make_solution = [this, version = made->solution_version()]() -> std::unique_ptr<NAlgo::ISolution> {
+                    std::string spec = this->portfolio.value();
+                    return NAlgo::MakePortfolio(
+                        spec, version, solution_config, this->optimizer_config.value(), this->target_weight, this->ga_opt
+                    );
+                };
+                solution = std::move(made);
+            } else if (this->warm_start.has_value()) {
+                NUtil::Ensure(
+                    this->warm_start.value() == "best" || test_name != "all",
+                    "a tour file can warm start a single test only"
+                );
+                solution_name = "WarmStart";
+                std::optional<std::filesystem::path> source;
+                if (this->warm_start.value() != "best") {
+                    source = this->warm_start.value();
+                }
+                make_solution = [this, source, version = NAlgo::GetSolutionVersion(solution_name)]() {
+                    return std::make_unique<NAlgo::WarmStart>(
+                        version, solution_config, source,
+                        [this](const NAlgo::Test& test) { return best_saved_tour(test); }
+                    );
+                };
+                solution = make_solution();
+            } else {
+                solution = NAlgo::MakeSolution(solution_name, solution_config, this->ga_opt);
+                make_solution = [this, code = NAlgo::ParseSolutionName(solution_name),
+                                 version = solution->solution_version()]() {
+                    return NAlgo::MakeSolution(code, version, solution_config, this->ga_opt);
+                };
+            }
             if (optimizer_name.has_value()) {
                 // todo ensure config has value
-                optimizer = NAlgo::MakeOptimizer(optimizer_name.value(), optimizer_config.value());
+                optimizer = NAlgo::MakePipeline(optimizer_name.value(), this->optimizer_config.value());
+                optimizer_spec = optimizer_name.value();
             }
         }
 
@@ -101,26 +174,28 @@ namespace NRunner {
 
                 out << "CONVERGENCE_SECTION" << std::endl;
 
-                int delta = result.tour.convergence.size() / 30;
-                for (size_t i = 0; i < result.tour.convergence.size(); i += delta) {
-                    out << result.tour.convergence[i].first
-                        << " "
-                        << result.tour.convergence[i].second
-                        << std::endl;
+                // the recorders already keep a bounded number of points, all of them are saved
+                for (const auto& point : result.tour.convergence) {
+                    out << point.iter << " " << point.weight << " " << point.elapsed_ms;
+                    if (point.duplicate_rate >= 0) {
+                        out << " " << point.duplicate_rate;
+                    }
+                    out << std::endl;
                 }
 
                 out << -1 << std::endl;
             }
         }
 
+        std::filesystem::path tour_path(const std::string& test) const {
+            return NConfig::CacheConfig::CACHE_DIRECTORY / (
+                test + "_" + solution->solution_name() + "_" + std::to_string(solution->solution_version()) + ".tour"
+            );
+        }
+
         void save(const std::vector<TestResult>& testResults) {
             for (auto result : testResults) {
-                std::filesystem::path path(
-                    NConfig::CacheConfig::CACHE_DIRECTORY / (
-                        result.tour.GetTestName() + "_" + solution->solution_name() + "_" + std::to_string(solution->solution_version()) + ".tour"
-                    )
-                );
-                std::ofstream out(path);
+                std::ofstream out(tour_path(result.tour.GetTestName()));
                 out << "NAME: " << result.tour.GetTestName() + "_"
                     + result.solution_name + "_"
                     + std::to_string(result.solution_version) << std::endl;
@@ -132,12 +207,27 @@ namespace NRunner {
                 if (optimizer) {
                     out << "OPTIMIZER: " << optimizer->optimizer_name() << std::endl;
                 }
+                if (portfolio) {
+                    out << "PORTFOLIO: " << portfolio.value() << std::endl;
+                    out << "WINNER: " << winner_name(result) << std::endl;
+                }
+                if (warm_start) {
+                    out << "WARM_START: " << warm_start.value() << std::endl;
+                }
 
                 if (comment.has_value()) {
                     out << "COMMENT: " << comment.value() << std::endl;
                 }
 
                 out << "TIME: " << result.run_time_ms << std::endl;
+                for (const auto& stage : result.stages) {
+                    out << "STAGE: " << stage.name << " BUDGET " << stage.budget_ms << " TIME " << stage.elapsed_ms
+                        << " WEIGHT " << stage.start_weight << " -> " << stage.end_weight << std::endl;
+                }
+
+                for (const auto& [name, value] : result.tour.statistics) {
+                    out << name << ": " << value << std::endl;
+                }
 
                 out << "TOUR_SECTION" << std::endl;
 
@@ -150,53 +240,223 @@ namespace NRunner {
         }
 
         std::vector<TestResult> run() {
+            return run_tests(false);
+        }
+
+        std::vector<TestResult> run_and_optimize() {
+            return run_tests(true);
+        }
+
+        /*
+            With jobs > 1 tests run on a pool of jobs threads, each with its own solution and
+            optimizer of the same versions, since algorithms keep state between calls. Larger
+            tests are queued first; results come back in the order of tests.
+         */
+        std::vector<TestResult> run_tests(bool with_optimizer) {
             std::vector<TestResult> result;
-            for (const auto& test : tests) {
-                result.push_back(run_on_single_test(test));
-                if (test_name == "all") {
-                    std::cout << "Ran successfully on test " << test.GetTestName() << ' '
-                    << " with score " << result.back().tour.TotalWeight() << std::endl;
-                } else {
-                    std::cout << "Ran successfully on test " << test_name << ' ' << " with score "
-                              << result.back().tour.TotalWeight() << std::endl;
+            if (jobs <= 1) {
+                for (const auto& test : tests) {
+                    result.push_back(run_on_single_test(test, *solution, with_optimizer ? optimizer.get() : nullptr));
+                    report(test, result.back());
                 }
+                return result;
+            }
+
+            std::vector<size_t> order(tests.size());
+            std::iota(order.begin(), order.end(), 0);
+            std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+                return tests[a].GetVertexNum() > tests[b].GetVertexNum();
+            });
+
+            ThreadPool pool(jobs);
+            std::vector<std::future<TestResult>> futures(tests.size());
+            for (size_t i : order) {
+                futures[i] = pool.enqueue([this, i, with_optimizer]() {
+                    auto job_solution = make_solution();
+                    std::unique_ptr<NAlgo::OptimizerPipeline> job_optimizer;
+                    if (with_optimizer) {
+                        std::string spec = optimizer_spec;
+                        job_optimizer = NAlgo::MakePipeline(spec, optimizer->optimizer_version(), *optimizer_config);
+                    }
+                    return run_on_single_test(tests[i], *job_solution, job_optimizer.get());
+                });
+            }
+            for (size_t i = 0; i < tests.size(); i++) {
+                result.push_back(futures[i].get());
+                report(tests[i], result.back());
             }
             return result;
         }
 
-        std::vector<TestResult> run_and_optimize() {
-            auto result = run();
-            for (size_t i = 0; i < tests.size(); i++) {
-                auto new_tour = optimize_on_single_test(tests[i], result[i].tour);
-                result[i].tour = new_tour;
-                result[i].optimizer_name = optimizer->optimizer_name();
-                result[i].optimizer_version = optimizer->optimizer_version();
-                std::cout << "Optimized test " << tests[i].GetTestName() << " new score " << new_tour.TotalWeight() << std::endl;
+        void report(const NAlgo::Test& test, const TestResult& result) const {
+            std::cout << "Ran successfully on test " << test.GetTestName() << ' ' << " with score "
+                      << (result.stages.empty() ? result.tour.TotalWeight() : result.stages.front().start_weight)
+                      << std::endl;
+            if (!result.stages.empty()) {
+                std::cout << "Optimized test " << test.GetTestName() << " new score " << result.tour.TotalWeight() << std::endl;
             }
+            if (portfolio) {
+                std::cout << "Portfolio winner " << winner_name(result) << std::endl;
+            }
+            for (const auto& [name, value] : result.tour.statistics) {
+                std::cout << "    " << name << ": " << value << std::endl;
+            }
+        }
+
+        /*
+         * the cache index knows the best tour of every instance without reading tours, the result
+         * files are searched only for tests that never went through the cache
+         */
+        std::optional<NAlgo::Tour> best_saved_tour(const NAlgo::Test& test) {
+            if (auto entry = cache.Best(test)) {
+                try {
+                    return NAlgo::ReadTour(test, cache.TourPath(entry.value()));
+                } catch (const std::runtime_error&) {
+                }
+            }
+            if (auto file = NAlgo::FindBestTour(test, NConfig::CacheConfig::CACHE_DIRECTORY)) {
+                return std::move(file->tour);
+            }
+            return std::nullopt;
+        }
+
+        std::string winner_name(const TestResult& result) const {
+            int winner = result.tour.statistics.at("PORTFOLIO_WINNER");
+            return NUtil::Split(portfolio.value(), ';')[winner];
+        }
+
+        /*
+         * everything the tour of a run depends on besides the test. The run counters solution_version and
+         * optimizer_version would make every key new, the code is versioned by ALGORITHMS_REVISION instead.
+         */
+        std::string run_config(const NAlgo::ISolution& test_solution, const NAlgo::OptimizerPipeline* test_optimizer) const {
+            std::ostringstream config;
+            config << "r" << NConfig::CacheConfig::ALGORITHMS_REVISION << "|";
+            if (portfolio) {
+                config << "Portfolio:" << portfolio.value();
+            } else if (warm_start) {
+                config << "WarmStart:" << warm_start.value();
+            } else {
+                config << test_solution.solution_name();
+            }
+            std::string hyperparameters = test_solution.hyperparameters();
+            if (!hyperparameters.empty()) {
+                config << "{" << hyperparameters << "}";
+            }
+            config << "|deadline=" << solution_config.deadline << "|threads=" << solution_config.thread_count;
+            if (test_optimizer) {
+                config << "|" << optimizer_spec;
+            }
+            if (optimizer_config) {
+                config << "|deadline=" << optimizer_config->deadline << "|threads=" << optimizer_config->thread_count;
+            }
+            // the index is split by spaces
+            std::string result = config.str();
+            std::replace(result.begin(), result.end(), ' ', '_');
             return result;
         }
 
-        TestResult run_on_single_test(const NAlgo::Test& test) {
+        /*
+         * run_time_ms is the wall time of this test only, construction and optimization together.
+         * *_OVERRUN_MS statistics show how far each part went past its deadline.
+         * A run is deterministic if its algorithms are and each of them returned before its deadline,
+         * the cache gives the tour of such a run instead of running it again.
+         */
+        TestResult run_on_single_test(const NAlgo::Test& test, NAlgo::ISolution& test_solution,
+                                      NAlgo::OptimizerPipeline* test_optimizer) {
             Timer timer;
 
-            auto tour = solution->solve(test);
+            std::string config = run_config(test_solution, test_optimizer);
+            bool deterministic = test_solution.deterministic() && (!test_optimizer || test_optimizer->deterministic());
+            if (deterministic && reuse_cached) {
+                if (auto cached = cache.Find(test, config)) {
+                    TestResult result{
+                        .tour = std::move(cached.value()),
+                        .solution_name = test_solution.solution_name(),
+                        .solution_version = test_solution.solution_version(),
+                    };
+                    if (test_optimizer) {
+                        result.optimizer_name = test_optimizer->optimizer_name();
+                        result.optimizer_version = test_optimizer->optimizer_version();
+                    }
+                    result.tour.statistics["CACHE_HIT"] = 1;
+                    result.run_time_ms = timer.Passed();
+                    return result;
+                }
+            }
 
-            return {
-                .tour = tour,
-                .solution_name = solution->solution_name(),
-                .solution_version = solution->solution_version(),
-                .run_time_ms = timer.Passed() + (optimizer ? optimizer->get_deadline() : 0)
-            };
-        }
+            // the best tour so far goes to the file of the result until the result itself is saved
+            std::unique_ptr<AnytimeWriter> writer;
+            if (snapshot_interval_ms > 0) {
+                writer = std::make_unique<AnytimeWriter>(
+                    tour_path(test.GetTestName()),
+                    test.GetTestName() + "_" + test_solution.solution_name() + "_"
+                        + std::to_string(test_solution.solution_version()),
+                    snapshot_interval_ms
+                );
+                test_solution.set_improvement_callback(writer->Callback());
+                if (test_optimizer) {
+                    test_optimizer->set_improvement_callback(writer->Callback());
+                }
+            }
 
-        NAlgo::Tour optimize_on_single_test(const NAlgo::Test& test, NAlgo::Tour tour)  {
-            return optimizer->optimize(test, std::move(tour));
+            auto tour = test_solution.solve(test);
+            // portfolio members optimize their tours within the solve call
+            double solution_deadline = solution_config.deadline + (portfolio ? optimizer_config->deadline : 0);
+            double solution_ms = timer.Passed();
+            tour.statistics["SOLUTION_OVERRUN_MS"] = std::max(0.0, solution_ms - solution_deadline);
+            deterministic = deterministic && solution_ms < solution_deadline;
+            TestResult result{
+                .tour = std::move(tour),
+                .solution_name = test_solution.solution_name(),
+                .solution_version = test_solution.solution_version(),
+            };
+            if (test_optimizer) {
+                Timer optimizer_timer;
+                double optimizer_start = timer.Passed();
+                size_t recorded = result.tour.convergence.size();
+                result.tour = test_optimizer->optimize(test, std::move(result.tour));
+                NAlgo::ShiftConvergence(result.tour.convergence, recorded, optimizer_start);
+                result.tour.statistics["OPTIMIZER_OVERRUN_MS"] =
+                    std::max(0.0, optimizer_timer.Passed() - test_optimizer->get_deadline());
+                result.optimizer_name = test_optimizer->optimizer_name();
+                result.optimizer_version = test_optimizer->optimizer_version();
+                result.stages = test_optimizer->Reports();
+                for (const auto& stage : result.stages) {
+                    deterministic = deterministic && stage.elapsed_ms < stage.budget_ms;
+                }
+            }
+            result.run_time_ms = timer.Passed();
+            result.tour.CalcTotalWeight();
+            cache.Store(result.tour, config, deterministic);
+            if (writer) {
+                test_solution.set_improvement_callback(nullptr);
+                if (test_optimizer) {
+                    test_optimizer->set_improvement_callback(nullptr);
+                }
+            }
+            return result;
         }
 
         std::unique_ptr<NAlgo::ISolution> solution;
-        std::unique_ptr<NAlgo::IOptimizer> optimizer;
+        std::unique_ptr<NAlgo::OptimizerPipeline> optimizer;
+        // a new instance of the solution with the same version, for concurrent jobs
+        std::function<std::unique_ptr<NAlgo::ISolution>()> make_solution;
+        NAlgo::SolutionConfig solution_config;
+        std::string optimizer_spec;
+        std::optional<NAlgo::OptimizerConfig> optimizer_config;
+        std::optional<std::string> portfolio;
+        int64_t target_weight;
+        double snapshot_interval_ms;
+        // a tour file or "best" for the best saved result, replaces the solution
+        std::optional<std::string> warm_start;
+        int jobs;
         std::string test_name;
         std::vector<NAlgo::Test> tests;
         std::optional<std::string> comment;
+        ResultCache cache;
+        // deterministic runs found in the cache are not run again
+        bool reuse_cached;
+        NAlgo::GAHyperOpt ga_opt;
     };
 }
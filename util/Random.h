@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+
+namespace NUtil {
+    /*
+     * xoshiro256** (Blackman, Vigna): a few shifts and rotations per number instead of the
+     * mt19937 state twist. Satisfies UniformRandomBitGenerator, so it also works with <random>.
+     */
+    class Xoshiro256 {
+    public:
+        using result_type = uint64_t;
+
+        explicit Xoshiro256(uint64_t seed = 0) {
+            // the state is filled with splitmix64 so that any seed, including 0, is usable
+            for (uint64_t& word : state) {
+                seed += 0x9e3779b97f4a7c15ULL;
+                uint64_t z = seed;
+                z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+                z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+                word = z ^ (z >> 31);
+            }
+        }
+
+        static constexpr result_type min() {
+            return 0;
+        }
+
+        static constexpr result_type max() {
+            return std::numeric_limits<result_type>::max();
+        }
+
+        result_type operator()() {
+            uint64_t result = rotl(state[1] * 5, 7) * 9;
+            uint64_t t = state[1] << 17;
+            state[2] ^= state[0];
+            state[3] ^= state[1];
+            state[1] ^= state[2];
+            state[0] ^= state[3];
+            state[2] ^= t;
+            state[3] = rotl(state[3], 45);
+            return result;
+        }
+
+        /* uniform in [0, bound) by multiply-shift, without a division */
+        uint32_t Below(uint32_t bound) {
+            return ((*this)() >> 32) * bound >> 32;
+        }
+
+        /* uniform in [0, 1) */
+        double NextDouble() {
+            return ((*this)() >> 11) * 0x1.0p-53;
+        }
+
+    private:
+        static uint64_t rotl(uint64_t x, int k) {
+            return (x << k) | (x >> (64 - k));
+        }
+
+        uint64_t state[4];
+    };
+}